@@ -1,6 +1,43 @@
 #ifndef OS_CPU_H
 #define OS_CPU_H
 
+#include "os_cfg.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#if (OS_CFG_PORT_POSIX == 1u)
+/*
+ * Host (Linux) port, see os_cpu_posix.c
+ * Tasks are ucontext contexts switched inside one process, tick is SIGALRM
+ * and "interrupts" are disabled by masking SIGALRM.
+ * NOTE: libc is not re-entrant across tasks (malloc, stdio locks are per thread,
+ * not per task), so SYS_PRINT in a host build should run inside ENTER_CRITICAL().
+ */
+#define DISABLE_INTERRUPTS          { os_cpu_irq_disable(); }
+#define ENABLE_INTERRUPTS           { os_cpu_irq_enable(); }
+
+/* Context switch is deferred till interrupts are enabled again, as PendSV does */
+#define os_cpu_setup_PendSV()       ((void)0)
+#define os_cpu_trigger_PendSV()     os_cpu_pend_switch()
+
+/* Nominal core clock, tick is still cpu_freq / 1000 (1ms) */
+#define OS_CPU_CORE_CLOCK           (1000000u)
+
+/* Native stack of each task, stack in task table is still allocated but unused */
+#define OS_CPU_POSIX_STK_SIZE       ((size_t)64u * 1024u)
+
+/* 1: tickless sleep takes no wall time, the simulated tick jumps straight to the wakeup.
+Makes tickless runs fast and deterministic */
+#ifndef OS_CPU_POSIX_SIM_SLEEP
+#define OS_CPU_POSIX_SIM_SLEEP      (0u)
+#endif
+
+extern void os_cpu_irq_disable(void);
+extern void os_cpu_irq_enable(void);
+extern void os_cpu_pend_switch(void);
+extern void os_cpu_SysTickHandler(void);
+
+#else
 #include "stm32l1xx.h"
 #include "core_cm3.h"
 #include "core_cmFunc.h"
@@ -18,6 +55,25 @@
 #define os_cpu_setup_PendSV()       (*(uint32_t volatile *)0xE000ED20 |= (0xFFU << 16))
 #define os_cpu_trigger_PendSV()     (*(uint32_t volatile *)0xE000ED04 = (1U << 28))
 
+#define OS_CPU_CORE_CLOCK           SystemCoreClock
+#endif
+
 extern void os_cpu_systick_init_freq(uint32_t cpu_freq);
 
-#endif
\ No newline at end of file
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+/* Stop tick for up to expected_idle_ticks and sleep, called by idle task with interrupts disabled.
+On wake, tick count is caught up with os_task_step_tick() */
+extern void os_cpu_suppress_ticks_and_sleep(uint32_t expected_idle_ticks);
+#endif
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+/* Core clock counts since the last tick, for hard timer lateness */
+extern uint32_t os_cpu_tick_elapsed_counts(void);
+#endif
+
+/* Build the initial frame of a task, returns value for stk_ptr of TCB */
+extern uint32_t *os_cpu_task_stack_init(uint32_t *p_stack, size_t stack_size, void (*pf_task)(void *), void *p_arg);
+
+extern void os_cpu_start_first_task(void);
+
+#endif
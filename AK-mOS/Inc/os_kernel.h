@@ -22,8 +22,8 @@ extern "C"
 #include <stdint.h>
 #include <stdio.h>
 
-#if OS_CFG_PRIO_MAX > 255u || OS_CFG_PRIO_MAX < 0u
-#error OS_CFG_PRIO_MAX have to be between 0-255
+#if OS_CFG_PRIO_MAX > 256u || OS_CFG_PRIO_MAX < 1u
+#error OS_CFG_PRIO_MAX have to be between 1-256
 #endif
 
 #define OS_TRUE             ((uint8_t)1)
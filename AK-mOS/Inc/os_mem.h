@@ -29,12 +29,19 @@ extern "C"
    {
       size_t size;
       mem_state_t state;
-      struct mem_blk_header *next_ptr;
+      struct mem_blk_header *next_ptr; /* Block just after in memory, NULL for the last one */
+      struct mem_blk_header *prev_ptr; /* Block just before in memory, so free merges in O(1) */
    };
 
    void *os_mem_malloc(size_t size);
    void os_mem_free(void *p_addr);
 
+   uint32_t os_mem_get_byte_available(void); /* Free payload bytes, sum of free blocks */
+
+   /* Walk the whole heap and check links, merging and byte count. O(n), for tests and debug.
+   Returns OS_TRUE if heap is consistent */
+   uint8_t os_mem_check(void);
+
 #ifdef __cplusplus
 }
 #endif
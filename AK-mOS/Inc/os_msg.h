@@ -14,11 +14,16 @@ extern "C"
 #endif
 
 #include "os_cfg.h"
+#include "os_pool.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
 
+#if (OS_CFG_MSG_INLINE_SIZE > 255u)
+#error OS_CFG_MSG_INLINE_SIZE have to be 255 or less
+#endif
+
     typedef struct msg msg_t;
     typedef struct msg_queue msg_queue_t;
     typedef struct msg_pool msg_pool_t;
@@ -33,39 +38,114 @@ extern "C"
     {
         msg_t *next;
 
-        uint8_t size;
+        uint16_t size; /* Up to 255 bytes, loaned msg up to 65535 */
         int32_t sig;
         uint8_t *content_ptr;
 
         msg_type_t type;
+        uint8_t payload_src; /* Where content_ptr comes from: inline, loan, size class of payload pool or heap */
+
+#if (OS_CFG_MSG_INLINE_SIZE > 0u)
+        union
+        {
+            uint8_t data[OS_CFG_MSG_INLINE_SIZE];
+            void *align; /* Payload can be read as words */
+        } inline_buf;
+#endif
 
         /* task header */
         uint8_t src_task_id;
         uint8_t des_task_id;
+#if (OS_CFG_USE_MSG_RPC == 1u)
+        uint8_t call_seq; /* Call a reply belongs to, src_task_id is caller */
+#endif
     };
 
+#define MSG_TASK_ID_NONE (0xFFu) /* src_task_id of a msg that is not a call */
+
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
+    typedef struct
+    {
+        uint16_t size;    /* Largest payload of class */
+        uint16_t blk_num;
+        uint16_t used;
+        uint16_t used_max;
+        uint32_t hit;  /* Payloads served by class */
+        uint32_t miss; /* Payloads sent to heap as class was empty */
+    } msg_payload_stats_t;
+#endif
+
+    /* What a post does when queue is full */
+    typedef enum
+    {
+        MSG_Q_OVERFLOW_ASSERT = 0,  /* Assert, new msg is lost (default) */
+        MSG_Q_OVERFLOW_DROP_NEWEST, /* New msg is dropped silently */
+        MSG_Q_OVERFLOW_DROP_OLDEST, /* Oldest msg is recycled for new one */
+        MSG_Q_MAILBOX               /* One slot, new msg replaces pending one */
+    } msg_q_policy_t;
+
     struct msg_queue
     {
         msg_t *head_ptr;
         msg_t *tail_ptr;
         uint8_t size_max;
         uint8_t size_curr;
+        msg_q_policy_t policy;
+        uint32_t num_dropped; /* Msgs lost to policy */
     };
 
     void os_msg_init(void);
 
     void os_msg_free(msg_t *p_msg);
 
-    void os_msg_queue_init(msg_queue_t *p_msg_q, uint8_t size);
+    /* Frees msgs linked by next (e.g. from os_task_wait_for_msgs), nodes go back to pool at once */
+    void os_msg_free_chain(msg_t *p_msg);
+
+    void os_msg_get_pool_stats(pool_stats_t *p_stats); /* Usage of kernel message pool */
+    uint16_t os_msg_get_pool_free(void);
 
-    void os_msg_queue_put_dynamic(msg_queue_t *p_msg_q, int32_t sig, void *p_content, uint8_t size);
+    /* Zero-copy: fill a loaned buffer, then post it with os_task_post_msg_loaned, ownership goes
+    to receiver and os_msg_free gives buffer back. NULL if no memory */
+    void *os_msg_loan(uint16_t size);
+    void os_msg_loan_return(void *p_buf); /* Gives back a loaned buffer that was not posted */
 
-    void os_msg_queue_put_pure(msg_queue_t *p_msg_q, int32_t sig);
+    /* Same buffer posted to count more tasks, it is freed when the last msg is freed.
+    Receivers of a shared buffer must only read it */
+    void os_msg_loan_add_ref(void *p_buf, uint8_t count);
+
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
+    uint8_t os_msg_get_payload_class_num(void);
+    void os_msg_get_payload_stats(uint8_t class_idx, msg_payload_stats_t *p_stats);
+#endif
+
+    void os_msg_queue_init(msg_queue_t *p_msg_q, uint8_t size, msg_q_policy_t policy);
+
+    uint32_t os_msg_queue_get_dropped(msg_queue_t *p_msg_q);
+
+    /* Returns OS_TRUE if msg is the wanted one. Called in critical section, keep it short */
+    typedef uint8_t (*msg_match_t)(msg_t *p_msg, void *p_arg);
+
+    /* Unlinks first msg that matches, NULL if none */
+    msg_t *os_msg_queue_get_match(msg_queue_t *p_msg_q, msg_match_t pf_match, void *p_arg);
+
+    /* Return queued msg, NULL if it was dropped */
+    msg_t *os_msg_queue_put_dynamic(msg_queue_t *p_msg_q, int32_t sig, void *p_content, uint8_t size);
+
+    void os_msg_queue_put_loaned(msg_queue_t *p_msg_q, int32_t sig, void *p_buf);
+
+    msg_t *os_msg_queue_put_pure(msg_queue_t *p_msg_q, int32_t sig);
+
+    /* Pure msg out of any queue, e.g. for a coalesced signal. Freed by os_msg_free.
+    NULL without assert if msg pool is empty */
+    msg_t *os_msg_make_pure(int32_t sig);
 
     msg_t *os_msg_queue_get(msg_queue_t *p_msg_q);
 
+    /* NULL and size 0 for a loaned msg over 255 bytes, use os_msg_get_data for those */
     void *os_msg_get_dynamic_data(msg_t *p_msg, uint8_t *p_msg_size);
 
+    void *os_msg_get_data(msg_t *p_msg, uint16_t *p_msg_size); /* Dynamic or loaned msg of any size */
+
     msg_t *os_msg_queue_get_pure(msg_queue_t *p_msg_q);
 
     int32_t os_msg_get_pure_data(msg_t *p_msg);
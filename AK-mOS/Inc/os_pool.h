@@ -0,0 +1,69 @@
+/*
+ * os_pool.h
+ *
+ *  Fixed-size block pool. Free blocks are linked through their first word,
+ *  so get and put are O(1) and safe to call from interrupts.
+ */
+
+#ifndef OS_POOL_H
+#define OS_POOL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "os_cfg.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Block size as kept in pool: at least one pointer, aligned to pointer size */
+#define OS_POOL_BLK_SIZE(size)      ((((size) < sizeof(void *) ? sizeof(void *) : (size)) + sizeof(void *) - 1u) & ~(sizeof(void *) - 1u))
+
+/* Static storage of a pool, e.g. static OS_POOL_BUF_DEF(my_buf, sizeof(my_obj_t), 10); */
+#define OS_POOL_BUF_DEF(name, size, num)    void *name[(OS_POOL_BLK_SIZE(size) * (num)) / sizeof(void *)]
+
+    typedef struct pool pool_t;
+
+    struct pool
+    {
+        void *free_list_ptr; /* First word of a free block links to the next one */
+        uint8_t *buf_ptr;
+        size_t blk_size;
+        uint16_t blk_num;
+        uint16_t used;
+        uint16_t used_max; /* High water mark */
+        uint32_t get_fail; /* Gets on an empty pool */
+        uint8_t is_heap;   /* Storage was taken from os_mem */
+    };
+
+    typedef struct
+    {
+        size_t blk_size;
+        uint16_t blk_num;
+        uint16_t used;
+        uint16_t used_max;
+        uint32_t get_fail;
+    } pool_stats_t;
+
+    /* p_buf has to hold blk_num blocks of OS_POOL_BLK_SIZE(blk_size), NULL to take it from heap */
+    void os_pool_create(pool_t *p_pool, void *p_buf, size_t blk_size, uint16_t blk_num);
+
+    /* Heap storage is given back, static storage is left to the caller */
+    void os_pool_delete(pool_t *p_pool);
+
+    void *os_pool_get(pool_t *p_pool); /* NULL if pool is empty */
+
+    void os_pool_put(pool_t *p_pool, void *p_blk);
+
+    /* Gives back num blocks linked through their first word at once, last link is ignored */
+    void os_pool_put_chain(pool_t *p_pool, void *p_first, uint16_t num);
+
+    void os_pool_get_stats(pool_t *p_pool, pool_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* OS_POOL_H */
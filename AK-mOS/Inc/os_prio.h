@@ -17,7 +17,8 @@ extern "C"
 #include <stdio.h>
 #include "os_cfg.h"
 
-#define OS_PRIO_TBL_SIZE (((OS_CFG_PRIO_MAX - 1u) / (8u)) + 1u)
+#define OS_PRIO_BITS_PER_ROW (32u)
+#define OS_PRIO_TBL_SIZE (((OS_CFG_PRIO_MAX - 1u) / OS_PRIO_BITS_PER_ROW) + 1u) /* Max 8 rows, one group word */
 
     void os_prio_init(void);
     void os_prio_insert(uint32_t prio);
@@ -44,6 +44,7 @@ extern "C"
     uint8_t prio;
     size_t queue_size;
     size_t stack_size;
+    msg_q_policy_t queue_policy; /* Left out of table = MSG_Q_OVERFLOW_ASSERT */
   } task_t;
 
 	uint32_t os_task_get_tick(void);
@@ -52,16 +53,103 @@ extern "C"
 
   uint8_t os_task_increment_tick(void);
 
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+  /* Called by port after tickless sleep (interrupts disabled), catches tick count up in one step */
+  uint8_t os_task_step_tick(uint32_t ticks_to_step);
+
+  /* Number of tick interrupts avoided by tickless idle */
+  uint32_t os_task_get_tick_suppressed(void);
+#endif
+
   void os_task_delay(const uint32_t tick_to_delay);
 
+  /* Delay till *p_last_wake + period (absolute), then *p_last_wake moves by one period.
+  Returns 0 if task was delayed, else how many ticks the deadline had already passed */
+  uint32_t os_task_delay_until(uint32_t *p_last_wake, const uint32_t period);
+
   void os_task_start(void);
 
   void os_task_post_msg_dynamic(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size);
 
   void os_task_post_msg_pure(uint8_t des_task_id, int32_t sig);
 
+  /* Posts a buffer from os_msg_loan without copy, caller must not touch it after */
+  void os_task_post_msg_loaned(uint8_t des_task_id, int32_t sig, void *p_buf);
+
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+  /* Post to urgent lane of task, received before any queued msg. Lane has OS_CFG_MSG_URGENT_Q_SIZE
+  slots of its own, a full lane asserts and rejects the post whatever queue_policy of task is */
+  void os_task_post_msg_dynamic_urgent(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size);
+  void os_task_post_msg_pure_urgent(uint8_t des_task_id, int32_t sig);
+  void os_task_post_msg_loaned_urgent(uint8_t des_task_id, int32_t sig, void *p_buf);
+#endif
+
+  /* Msgs lost to queue_policy of task (dropped or overwritten) */
+  uint32_t os_task_get_msg_dropped(uint8_t task_id);
+
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+  /* Block caller till destination queue and msg pool have room or time_out expires, highest prio
+  sender goes first. Returns OS_TRUE if msg was posted. Only from tasks, time_out 0 never blocks */
+  uint8_t os_task_post_msg_dynamic_timeout(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size, uint32_t time_out);
+  uint8_t os_task_post_msg_pure_timeout(uint8_t des_task_id, int32_t sig, uint32_t time_out);
+  uint8_t os_task_post_msg_loaned_timeout(uint8_t des_task_id, int32_t sig, void *p_buf, uint32_t time_out); /* On OS_FALSE caller keeps buffer */
+#endif
+
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u) || (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+  void os_task_wake_msg_pool_waiter(void); /* Called by os_msg_free */
+#endif
+
+#if (OS_CFG_USE_MSG_PUBSUB == 1u)
+  /* Task gets every msg published with sig_first <= sig <= sig_last (task id below 32) */
+  void os_task_subscribe(uint8_t task_id, int32_t sig_first, int32_t sig_last);
+  void os_task_unsubscribe(uint8_t task_id, int32_t sig_first, int32_t sig_last);
+
+  /* Payload is copied once and shared by all subscribers, size 0 sends pure msg.
+  Returns num of subscribers */
+  uint8_t os_task_publish(int32_t sig, void *p_content, uint16_t size);
+  /* Same with a buffer from os_msg_loan, no copy at all */
+  uint8_t os_task_publish_loaned(int32_t sig, void *p_buf);
+#endif
+
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+  /* Pure signals sig_first..sig_first+num-1 (num <= 32) posted to task are kept as pending bits, a
+  repeated signal is posted once. Wait returns them before queued msgs, lowest signal first.
+  num 0 turns it off. Signals pending at the call are dropped */
+  void os_task_coalesce_sig(uint8_t task_id, int32_t sig_first, uint8_t num);
+#endif
+
   msg_t *os_task_wait_for_msg(uint32_t time_out);
 
+#if (OS_CFG_USE_MSG_WAIT_SIG == 1u)
+  /* Takes first msg with (sig & sig_mask) == (wanted sig & sig_mask) wherever it is in queue, other
+  msgs stay queued in order. Task is only woken by a match. sig_mask 0xFFFFFFFF: exactly sig */
+  msg_t *os_task_wait_for_sig(int32_t sig, uint32_t sig_mask, uint32_t time_out);
+  /* Same with a predicate, it runs in critical section of posters too */
+  msg_t *os_task_wait_for_msg_match(msg_match_t pf_match, void *p_arg, uint32_t time_out);
+#endif
+
+#if (OS_CFG_USE_TASK_HANDOFF == 1u)
+  /* A task woken by a msg normally waits for next round-robin tick if it has same prio as sender.
+  With handoff on, posts that wake it switch to it at once (per task) */
+  void os_task_set_handoff(uint8_t task_id, uint8_t is_enabled);
+  /* Per post: switch now to task_id if it is ready and has same prio, e.g. right after a post */
+  void os_task_handoff(uint8_t task_id);
+#endif
+
+#if (OS_CFG_USE_MSG_RPC == 1u)
+  /* Posts req (req_len 0: pure msg) and blocks till server replies or time_out expires. *p_rsp_len is
+  size of p_rsp, then size of reply. Returns OS_TRUE if replied. Only from tasks */
+  uint8_t os_task_call(uint8_t des_task_id, int32_t sig, void *p_req, uint8_t req_len,
+                       void *p_rsp, uint16_t *p_rsp_len, uint32_t time_out);
+  /* Server copies reply into caller buffer (cut to its size) and readies it, call it before
+  os_msg_free. Returns OS_FALSE if caller has timed out */
+  uint8_t os_task_reply(msg_t *p_msg, void *p_data, uint16_t len);
+#endif
+
+  /* Takes up to num msgs at once as a chain linked by next in *pp_msgs, blocks only if there
+  is none. Returns num of msgs, free them with os_msg_free_chain (or one by one) */
+  uint8_t os_task_wait_for_msgs(msg_t **pp_msgs, uint8_t num, uint32_t time_out);
+
 #ifdef __cplusplus
 }
 #endif
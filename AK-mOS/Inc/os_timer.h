@@ -12,7 +12,9 @@
 extern "C"
 {
 #endif
+#include "os_cfg.h"
 #include "os_list.h"
+#include "os_pool.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -28,6 +30,24 @@ extern "C"
         TIMER_PERIODIC
     } timer_type_t;
 
+    /* What a periodic timer does when it is processed a whole period or more late */
+    typedef enum
+    {
+        TIMER_OVERRUN_SKIP = 0,  /* Fire once, skip missed periods, keep phase (default) */
+        TIMER_OVERRUN_CATCH_UP,  /* Fire once per missed period, keep phase */
+        TIMER_OVERRUN_REALIGN    /* Fire once, next period starts from now */
+    } timer_overrun_t;
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    typedef struct
+    {
+        uint32_t min; /* Core clock counts */
+        uint32_t max;
+        uint32_t avg;
+        uint32_t count; /* Callbacks measured */
+    } timer_jitter_t;
+#endif
+
     struct timer
     {
         os_timer_t *next;
@@ -36,22 +56,65 @@ extern "C"
 
         int32_t sig; /* Timer signal*/
         uint8_t des_task_id;
-        timer_cb func_cb; /* Callback funtion runs on timer task, !!! keep it short and simple as in interrupt*/
+        timer_cb func_cb; /* Callback funtion runs on timer task (idle task if OS_CFG_USE_TIMER_TASK is 0), !!! keep it short and simple as in interrupt*/
 
         uint32_t period; /* In case one-shot timer, this field equals 0 */
+
+        timer_overrun_t overrun_policy;
+        uint32_t overrun_count; /* Whole periods missed since created */
+
+        uint32_t expiry; /* Tick timer is due, value of timer_list_item may be later by up to slack */
+        uint32_t slack;  /* Ticks timer may fire late to share a wakeup with other timers */
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+        uint8_t hard;        /* Callback runs in tick interrupt */
+        uint32_t late_min;   /* Lateness of callback from expiry tick, in core clock counts */
+        uint32_t late_max;
+        uint32_t late_count;
+        uint64_t late_sum;
+#endif
     };
 
     void os_timer_init(void); /* Runs on kernel init */
 
+#if (OS_CFG_USE_TIMER_TASK == 1u)
     void os_timer_processing(); /* Runs on timer task */
+#else
+    void os_timer_tick_processing(void); /* Runs in tick interrupt, expires timers and queues their callbacks */
+    void os_timer_run_deferred(void);    /* Runs on idle task, calls queued callbacks */
+    uint8_t os_timer_has_deferred(void);
+#endif
+
+    uint8_t os_timer_get_next_tick(uint32_t *p_tick); /* Tick of the earliest timer, OS_FALSE if none */
 
     /* These APIs run on other tasks, where they are calling*/
     os_timer_t *os_timer_create(timer_id_t id, int32_t sig, timer_cb func_cb, uint8_t des_task_id, uint32_t period, timer_type_t type);
 
     void os_timer_start(os_timer_t *p_timer, uint32_t tick_to_wait);
+    /* Timer may fire up to slack ticks late, so timers with overlapping windows share one wakeup.
+    Slack is kept for periodic re-arm and reset */
+    void os_timer_start_slack(os_timer_t *p_timer, uint32_t tick_to_wait, uint32_t slack);
     void os_timer_reset(os_timer_t *p_timer);
     void os_timer_remove(os_timer_t *p_timer);
 
+    void os_timer_set_overrun_policy(os_timer_t *p_timer, timer_overrun_t policy);
+    uint32_t os_timer_get_overrun(os_timer_t *p_timer);
+    uint32_t os_timer_get_wakeups_saved(void); /* Wakeups of timer service avoided by slack */
+    void os_timer_get_pool_stats(pool_stats_t *p_stats); /* Usage of timer pool */
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    /* Hard timer: callback runs in tick interrupt, right on its tick. It is started, reset and
+    removed with APIs above, slack is not used. Callback runs with interrupts disabled, so it
+    may only post messages and start/reset/remove timers, it must never block (delay, wait) */
+    os_timer_t *os_timer_create_hard(timer_id_t id, timer_cb func_cb, uint32_t period, timer_type_t type);
+
+    void os_timer_hard_processing(void); /* Runs in tick interrupt */
+    uint32_t os_timer_hard_get_next_delta(void); /* Ticks to next hard timer event, OS_CFG_DELAY_MAX if none */
+    uint8_t os_timer_in_hard_cb(void);
+
+    void os_timer_get_jitter(os_timer_t *p_timer, timer_jitter_t *p_jitter);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,54 @@
+/*
+ * os_wheel.h
+ *
+ *  Hierarchical timing wheel. Items are list items whose value is the absolute
+ *  tick to expire, so they are removed with os_list_remove as from any list.
+ */
+
+#ifndef OS_WHEEL_H
+#define OS_WHEEL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include "os_cfg.h"
+#include "os_list.h"
+
+#define OS_WHEEL_SLOTS          ((uint32_t)1u << OS_CFG_WHEEL_SLOT_BITS)
+#define OS_WHEEL_MASK           (OS_WHEEL_SLOTS - 1u)
+#define OS_WHEEL_RANGE          ((uint32_t)1u << (OS_CFG_WHEEL_SLOT_BITS * OS_CFG_WHEEL_LEVELS))
+
+#if (OS_CFG_WHEEL_SLOT_BITS * OS_CFG_WHEEL_LEVELS) > 31u
+#error OS_CFG_WHEEL_SLOT_BITS * OS_CFG_WHEEL_LEVELS have to be less than 32
+#endif
+
+    typedef struct wheel wheel_t;
+
+    struct wheel
+    {
+        list_t slot[OS_CFG_WHEEL_LEVELS][OS_WHEEL_SLOTS]; /* Level 0 has 1 tick per slot, level n has SLOTS^n ticks per slot */
+        uint32_t time;                                     /* Tick the wheel is at */
+    };
+
+    void os_wheel_init(wheel_t *p_wheel, uint32_t time_now);
+
+    /* Value of item is the tick to expire, it has to be after wheel time */
+    void os_wheel_insert(wheel_t *p_wheel, list_item_t *p_item);
+
+    /* Move wheel one tick forward, return the slot holding every item expired on that tick */
+    list_t *os_wheel_tick(wheel_t *p_wheel);
+
+    /* Ticks until wheel has something to do (expiry or cascade), OS_CFG_DELAY_MAX if empty */
+    uint32_t os_wheel_get_next_delta(wheel_t *p_wheel);
+
+    /* Move wheel time forward by up to max_ticks with nothing to do on the way, return ticks moved */
+    uint32_t os_wheel_skip(wheel_t *p_wheel, uint32_t max_ticks);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* OS_WHEEL_H */
@@ -2,6 +2,7 @@
 #include "os_task.h"
 #include "os_kernel.h"
 
+#if (OS_CFG_PORT_POSIX == 0u)
 
 #include "stm32l1xx.h"
 #include "stm32l1xx_conf.h"
@@ -9,10 +10,19 @@
 #include "core_cm3.h"
 #include "core_cmFunc.h"
 
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+#define SYSTICK_MAX_COUNT           (0x00FFFFFFUL)  /* SysTick is a 24 bit counter */
+
+static uint32_t systick_counts_per_tick;
+#endif
+
 /*Passing SystemCoreClock to init tick at every 1ms*/
 void os_cpu_systick_init_freq(uint32_t cpu_freq)
 {
 	volatile uint32_t ticks = cpu_freq / 1000;
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+	systick_counts_per_tick = ticks;
+#endif
 	NVIC_InitTypeDef NVIC_InitStructure;
 
 	NVIC_InitStructure.NVIC_IRQChannel = SysTick_IRQn;
@@ -31,6 +41,118 @@ void os_cpu_systick_init_freq(uint32_t cpu_freq)
 			    SysTick_CTRL_ENABLE_Msk; /* Enable SysTick IRQ and SysTick Timer */
 }
 
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+uint32_t os_cpu_tick_elapsed_counts(void)
+{
+	/* SysTick counts down from LOAD, reloaded on every tick */
+	return SysTick->LOAD - SysTick->VAL;
+}
+#endif
+
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+/* Runs on idle task with interrupts disabled, any pending interrupt still wakes WFI */
+void os_cpu_suppress_ticks_and_sleep(uint32_t expected_idle_ticks)
+{
+	uint32_t reload;
+	uint32_t ctrl;
+	uint32_t completed_counts;
+	uint32_t rest_counts;
+	uint32_t complete_ticks;
+
+	if (expected_idle_ticks > (SYSTICK_MAX_COUNT / systick_counts_per_tick))
+	{
+		expected_idle_ticks = SYSTICK_MAX_COUNT / systick_counts_per_tick;
+	}
+
+	/* Stop SysTick, the part of current tick already counted is kept */
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	reload = SysTick->VAL + (systick_counts_per_tick * (expected_idle_ticks - 1u));
+	SysTick->LOAD = reload;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+	__asm volatile("dsb \n"
+		       "wfi \n"
+		       "isb \n");
+
+	/* Reading CTRL clears COUNTFLAG, read it once */
+	ctrl = SysTick->CTRL;
+	SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+	if ((ctrl & SysTick_CTRL_COUNTFLAG_Msk) != 0u)
+	{
+		/* Woken by tick, its interrupt is pending and counts the last tick
+		when interrupts are enabled. Reload the rest of the tick after that one. */
+		rest_counts = (systick_counts_per_tick - 1u) - (reload - SysTick->VAL);
+		if (rest_counts > systick_counts_per_tick)
+		{
+			/* Wake took longer than one tick */
+			rest_counts = systick_counts_per_tick - 1u;
+		}
+		SysTick->LOAD = rest_counts;
+		complete_ticks = expected_idle_ticks - 1u;
+	}
+	else
+	{
+		/* Woken by another interrupt, count whole ticks and finish current one */
+		completed_counts = reload - SysTick->VAL;
+		complete_ticks = completed_counts / systick_counts_per_tick;
+		SysTick->LOAD = ((complete_ticks + 1u) * systick_counts_per_tick) - completed_counts;
+	}
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+	if (os_task_step_tick(complete_ticks) == OS_TRUE)
+	{
+		os_cpu_trigger_PendSV();
+	}
+
+	/* Next reload is a normal tick */
+	SysTick->LOAD = systick_counts_per_tick - 1u;
+}
+#endif
+
+/* For strict compliance with the Cortex-M spec the task start address should
+have bit-0 clear, as it is loaded into the PC on exit from an ISR. */
+#define VALUE_START_ADDRESS_MASK    ((uint32_t)0xfffffffeUL)
+
+/* Constants required to set up the initial stack. */
+#define VALUE_INITIAL_XPSR          (0x01000000)
+
+uint32_t *os_cpu_task_stack_init(uint32_t *p_stack, size_t stack_size, void (*pf_task)(void *), void *p_arg)
+{
+	uint32_t *p_stack_ptr;
+
+	/*Init stack frame*/
+	p_stack_ptr = &p_stack[stack_size - (uint32_t)1];
+	p_stack_ptr = (uint32_t *)(((uint32_t)p_stack_ptr) & (~((uint32_t)0x007))); /* Allign byte */
+	*(--p_stack_ptr) = VALUE_INITIAL_XPSR;                             /*Add offset and assign value for xPSR */
+	*(--p_stack_ptr) = ((uint32_t)pf_task) & VALUE_START_ADDRESS_MASK; /* PC */
+	*(--p_stack_ptr) = (uint32_t)0x000000EU;                           /* LR */
+	p_stack_ptr -= 5;                                                  /* R12, R3, R2 and R1. */
+	*p_stack_ptr = (uint32_t)p_arg;                                    /* R0 */
+	p_stack_ptr -= 8;                                                  /* R11, R10, R9, R8, R7, R6, R5 and R4. */
+
+	return p_stack_ptr;
+}
+
+void os_cpu_start_first_task(void)
+{
+	__asm volatile(
+	    " ldr r0, =0xE000ED08 	    \n" /* Use the NVIC offset register to locate the stack. */
+	    " ldr r0, [r0] 	            \n"
+	    " ldr r0, [r0] 			    \n"
+	    " msr msp, r0			    \n" /* Set the msp back to the start of the stack. */
+	    " cpsie i			        \n" /* Globally enable interrupts. */
+	    " cpsie f		            \n"
+	    " dsb			            \n"
+	    " isb			            \n"
+	    " svc 0		                \n" /* System call to start first task. */
+	    " nop			            \n"
+	    " .ltorg                    \n"
+	);
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -102,7 +224,8 @@ extern "C"
 #endif
 	void os_cpu_SysTickHandler()
 	{
-		DISABLE_INTERRUPTS
+		/* Counted critical section, timers expired in tick path post messages that nest it */
+		ENTER_CRITICAL();
 		/* Increment the RTOS tick. */
 		if (os_task_increment_tick() == OS_TRUE)
 		{
@@ -110,9 +233,11 @@ extern "C"
 			 * the PendSV interrupt.  Pend the PendSV interrupt. */
 			os_cpu_trigger_PendSV();
 		}
-		ENABLE_INTERRUPTS
+		EXIT_CRITICAL();
 	}
 
 #ifdef __cplusplus
 }
 #endif
+
+#endif /* OS_CFG_PORT_POSIX == 0u */
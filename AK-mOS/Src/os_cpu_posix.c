@@ -0,0 +1,273 @@
+/*
+ * os_cpu_posix.c
+ *
+ *  Host (Linux) port of the os_cpu layer. Kernel and app_task_table run as a
+ *  normal process, so scheduler, message and timer paths can be profiled with
+ *  perf/valgrind and benchmarked off target.
+ *
+ *  - Context switch: one ucontext per task, switched with swapcontext()
+ *  - Tick source   : SIGALRM from setitimer(), calls os_cpu_SysTickHandler()
+ *  - Critical      : SIGALRM is masked, same as CPSID I on Cortex-M3
+ *  - PendSV        : a pending flag, the switch runs when interrupts are enabled again
+ */
+
+#define _GNU_SOURCE
+
+#include "os_cpu.h"
+#include "os_task.h"
+#include "os_kernel.h"
+
+#if (OS_CFG_PORT_POSIX == 1u)
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+typedef struct
+{
+	ucontext_t uc;
+	void (*pf_task)(void *);
+	void *p_arg;
+} cpu_ctx_t;
+
+/* As in PendSV handler of Cortex-M3 port, stk_ptr is the first member of TCB.
+In this port it holds the context of task instead of the stack pointer */
+extern struct task_tcb *volatile tcb_curr_ptr;
+extern struct task_tcb *volatile tcb_high_rdy_ptr;
+
+#define cpu_get_ctx(p_tcb)          (*(cpu_ctx_t *volatile *)(p_tcb))
+
+static volatile sig_atomic_t irq_disabled   = 0;
+static volatile sig_atomic_t switch_pending = 0;
+
+static struct itimerval tick_period;
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+static struct timespec tick_time; /* When the last tick was taken */
+#endif
+
+static void cpu_mask_tick(int how)
+{
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	sigprocmask(how, &set, NULL);
+}
+
+/* Same job as PendSV handler, always called with tick masked */
+static void cpu_switch_context(void)
+{
+	cpu_ctx_t *p_prev = cpu_get_ctx(tcb_curr_ptr);
+	cpu_ctx_t *p_next;
+
+	switch_pending = 0;
+	tcb_curr_ptr = tcb_high_rdy_ptr;
+	p_next = cpu_get_ctx(tcb_curr_ptr);
+	if (p_prev != p_next)
+	{
+		/* Returns when p_prev is switched in again, still with tick masked */
+		swapcontext(&(p_prev->uc), &(p_next->uc));
+	}
+}
+
+static void cpu_task_entry(void)
+{
+	cpu_ctx_t *p_ctx = cpu_get_ctx(tcb_curr_ptr);
+
+	/* First run of task, context was created with tick masked */
+	irq_disabled = 0;
+	cpu_mask_tick(SIG_UNBLOCK);
+
+	p_ctx->pf_task(p_ctx->p_arg);
+
+	/* Task functions must never return */
+	os_assert(0, "OS_ERR_TASK_RETURNED");
+	abort();
+}
+
+static void cpu_tick_signal_handler(int sig)
+{
+	int saved_errno = errno;
+	(void)sig;
+	os_cpu_SysTickHandler();
+	errno = saved_errno;
+}
+
+void os_cpu_irq_disable(void)
+{
+	cpu_mask_tick(SIG_BLOCK);
+	irq_disabled = 1;
+}
+
+void os_cpu_irq_enable(void)
+{
+	if (switch_pending)
+	{
+		cpu_switch_context();
+	}
+	irq_disabled = 0;
+	cpu_mask_tick(SIG_UNBLOCK);
+}
+
+void os_cpu_pend_switch(void)
+{
+	switch_pending = 1;
+	if (!irq_disabled)
+	{
+		/* Interrupts enabled, switch right now as PendSV would do */
+		os_cpu_irq_disable();
+		os_cpu_irq_enable();
+	}
+}
+
+/*Passing core clock to init tick at every 1ms*/
+void os_cpu_systick_init_freq(uint32_t cpu_freq)
+{
+	uint32_t ticks = cpu_freq / 1000;
+	struct sigaction sa;
+
+	/* Tick stays masked till the first task runs */
+	os_cpu_irq_disable();
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = cpu_tick_signal_handler;
+	sigemptyset(&sa.sa_mask);
+	sigaddset(&sa.sa_mask, SIGALRM);
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGALRM, &sa, NULL);
+
+	tick_period.it_interval.tv_sec = 0;
+	tick_period.it_interval.tv_usec = (suseconds_t)(((uint64_t)ticks * 1000000u) / cpu_freq);
+	tick_period.it_value = tick_period.it_interval;
+	setitimer(ITIMER_REAL, &tick_period, NULL);
+}
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+uint32_t os_cpu_tick_elapsed_counts(void)
+{
+	struct timespec time_now;
+	clock_gettime(CLOCK_MONOTONIC, &time_now);
+	/* Core clock is 1MHz, a count is 1us */
+	return (uint32_t)((time_now.tv_sec - tick_time.tv_sec) * 1000000 + (time_now.tv_nsec - tick_time.tv_nsec) / 1000);
+}
+#endif
+
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+/* Called by idle task with tick masked */
+void os_cpu_suppress_ticks_and_sleep(uint32_t expected_idle_ticks)
+{
+	uint32_t elapsed_ticks = expected_idle_ticks;
+#if (OS_CPU_POSIX_SIM_SLEEP == 0u)
+	const uint64_t tick_us = (uint64_t)tick_period.it_interval.tv_usec;
+	uint64_t sleep_us = (uint64_t)expected_idle_ticks * tick_us;
+	struct itimerval wakeup;
+	struct timespec time_start;
+	struct timespec time_end;
+	sigset_t set;
+
+	clock_gettime(CLOCK_MONOTONIC, &time_start);
+
+	/* Periodic tick is replaced by one wakeup. A tick already pending returns at once */
+	memset(&wakeup, 0, sizeof(wakeup));
+	wakeup.it_value.tv_sec = (time_t)(sleep_us / 1000000u);
+	wakeup.it_value.tv_usec = (suseconds_t)(sleep_us % 1000000u);
+	setitimer(ITIMER_REAL, &wakeup, NULL);
+
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	while (sigwaitinfo(&set, NULL) < 0)
+	{
+		/* Interrupted by another signal */
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &time_end);
+	setitimer(ITIMER_REAL, &tick_period, NULL);
+
+	elapsed_ticks = (uint32_t)(((uint64_t)(time_end.tv_sec - time_start.tv_sec) * 1000000u +
+				    (uint64_t)((time_end.tv_nsec - time_start.tv_nsec) / 1000)) / tick_us);
+	if (elapsed_ticks == 0u)
+	{
+		/* A tick was already pending */
+		elapsed_ticks = 1u;
+	}
+	else if (elapsed_ticks > expected_idle_ticks)
+	{
+		/* Woken by the wakeup tick, extra time is host scheduling jitter */
+		elapsed_ticks = expected_idle_ticks;
+	}
+#endif
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+	clock_gettime(CLOCK_MONOTONIC, &tick_time);
+#endif
+	/* As SysTick woke the cpu: ticks before the last are stepped, last one is a normal tick */
+	if (os_task_step_tick(elapsed_ticks - 1u) == OS_TRUE)
+	{
+		os_cpu_trigger_PendSV();
+	}
+	if (os_task_increment_tick() == OS_TRUE)
+	{
+		os_cpu_trigger_PendSV();
+	}
+}
+#endif
+
+uint32_t *os_cpu_task_stack_init(uint32_t *p_stack, size_t stack_size, void (*pf_task)(void *), void *p_arg)
+{
+	cpu_ctx_t *p_ctx;
+
+	/* Stack from task table is too small for libc, task runs on a native stack */
+	(void)p_stack;
+	(void)stack_size;
+
+	p_ctx = (cpu_ctx_t *)calloc(1u, sizeof(cpu_ctx_t));
+	if (p_ctx == NULL)
+	{
+		os_assert(0, "OS_ERR_TCB_NOT_ENOUGH_MEM_ALLOC");
+		abort();
+	}
+	p_ctx->pf_task = pf_task;
+	p_ctx->p_arg = p_arg;
+
+	getcontext(&(p_ctx->uc));
+	p_ctx->uc.uc_stack.ss_sp = malloc(OS_CPU_POSIX_STK_SIZE);
+	p_ctx->uc.uc_stack.ss_size = OS_CPU_POSIX_STK_SIZE;
+	p_ctx->uc.uc_link = NULL;
+	if (p_ctx->uc.uc_stack.ss_sp == NULL)
+	{
+		os_assert(0, "OS_ERR_TCB_NOT_ENOUGH_MEM_ALLOC");
+		abort();
+	}
+	sigemptyset(&(p_ctx->uc.uc_sigmask));
+	sigaddset(&(p_ctx->uc.uc_sigmask), SIGALRM);
+	makecontext(&(p_ctx->uc), cpu_task_entry, 0);
+
+	return (uint32_t *)p_ctx;
+}
+
+void os_cpu_start_first_task(void)
+{
+	switch_pending = 0;
+	setcontext(&(cpu_get_ctx(tcb_curr_ptr)->uc));
+}
+
+void os_cpu_SysTickHandler(void)
+{
+	/* Counted critical section, timers expired in tick path post messages that nest it */
+	ENTER_CRITICAL();
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+	clock_gettime(CLOCK_MONOTONIC, &tick_time);
+#endif
+	/* Increment the RTOS tick. */
+	if (os_task_increment_tick() == OS_TRUE)
+	{
+		/* A context switch is required, it is done when interrupts are enabled */
+		os_cpu_trigger_PendSV();
+	}
+	EXIT_CRITICAL();
+}
+
+#endif /* OS_CFG_PORT_POSIX == 1u */
@@ -26,24 +26,6 @@ void os_critical_exit(void)
     }
 }
 
-static void
-os_start_first_task(void)
-{
-    __asm volatile(
-        " ldr r0, =0xE000ED08 	    \n" /* Use the NVIC offset register to locate the stack. */
-        " ldr r0, [r0] 	            \n"
-        " ldr r0, [r0] 			    \n"
-        " msr msp, r0			    \n" /* Set the msp back to the start of the stack. */
-        " cpsie i			        \n" /* Globally enable interrupts. */
-        " cpsie f		            \n"
-        " dsb			            \n"
-        " isb			            \n"
-        " svc 0		                \n" /* System call to start first task. */
-        " nop			            \n"
-        " .ltorg                    \n"
-    );
-}
-
 void os_init(void)
 {
     if (TASK_EOT_ID < 1u)
@@ -60,7 +42,7 @@ void os_init(void)
 void os_run(void)
 {
     os_task_start();
-    os_cpu_systick_init_freq(SystemCoreClock);
+    os_cpu_systick_init_freq(OS_CPU_CORE_CLOCK);
     os_cpu_setup_PendSV();
-    os_start_first_task();
+    os_cpu_start_first_task();
 }
@@ -14,9 +14,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-
+#if (OS_CFG_USE_MEM_TLSF == 0u) /* Else see os_mem_tlsf.c */
 #if 1
-#define ALIGNMENT 		((size_t)4u) // must be a power of 2
+#define ALIGNMENT 		((size_t)sizeof(void *)) // must be a power of 2, 4 on Cortex-M3
 
 #define mem_align(size) 	(size_t)(((size) + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1))
 
@@ -34,18 +34,20 @@ static uint32_t byte_available = 0;
 static void os_mem_heap_init(void)
 {
 	uint32_t total_heap_size = OS_CFG_HEAP_SIZE;
-	uint32_t heap_addr = (uint32_t)mem_heap;
+	uintptr_t heap_addr = (uintptr_t)mem_heap;
 	if ((heap_addr & (ALIGNMENT - 1)) != 0) /* If address of heap memory is not alligned	*/
 	{
 		heap_addr += (ALIGNMENT - 1);
-		heap_addr &= ALIGNMENT;
-		total_heap_size -= heap_addr - (uint32_t)mem_heap; /* Recalculate size of heap memory	*/
+		heap_addr &= ~((uintptr_t)ALIGNMENT - 1);
+		total_heap_size -= heap_addr - (uintptr_t)mem_heap; /* Recalculate size of heap memory	*/
 	}
+	total_heap_size &= ~((uint32_t)ALIGNMENT - 1);
 
 	mem_blk_end_ptr = (mem_blk_header_t *)(heap_addr); /* Address of first block	*/
 	mem_blk_end_ptr->size = total_heap_size - SIZE_OF_BLOCK_HEADER;
 	mem_blk_end_ptr->state = MEM_STATE_FREE;
 	mem_blk_end_ptr->next_ptr = NULL;
+	mem_blk_end_ptr->prev_ptr = NULL;
 
 	mem_blk_start.size = 0;
 	mem_blk_start.next_ptr = mem_blk_end_ptr;
@@ -69,63 +71,68 @@ void *os_mem_malloc(size_t size)
 
 	else
 	{
-		mem_blk_header_t *p_block = &mem_blk_start;
-		p_block = p_block->next_ptr;
-		while (p_block != mem_blk_end_ptr)
+		/* First fit */
+		mem_blk_header_t *p_block = mem_blk_start.next_ptr;
+		while (p_block != NULL && (p_block->size < size || p_block->state == MEM_STATE_BUSY))
 		{
-			if (p_block->size < size || p_block->state == MEM_STATE_BUSY)
-			{
-				p_block = p_block->next_ptr;
-			}
-			else
-				break;
+			p_block = p_block->next_ptr;
 		}
-		if (p_block != NULL)
+		if (p_block == NULL)
 		{
-			if (p_block == mem_blk_end_ptr && p_block->size < size)
-			{
-				os_assert(0, "OS_ERR_MEM_NO_BLOCK");
-				return (void *)p_return; // No block available
-			}
+			os_assert(0, "OS_ERR_MEM_NO_BLOCK");
+			return (void *)p_return; // No block available
+		}
 
-			if ((p_block->size - size) > MIN_SIZE_TO_SPLIT)
+		p_return = ((uint8_t *)p_block + SIZE_OF_BLOCK_HEADER);
+		if (p_block->size >= (size + SIZE_OF_BLOCK_HEADER + MIN_SIZE_TO_SPLIT))
+		{
+			mem_blk_header_t *p_new_block = (mem_blk_header_t *)(((uint8_t *)p_block) + SIZE_OF_BLOCK_HEADER + size);
+			p_new_block->size = p_block->size - size - SIZE_OF_BLOCK_HEADER;
+			p_new_block->state = MEM_STATE_FREE;
+			p_new_block->next_ptr = p_block->next_ptr;
+			p_new_block->prev_ptr = p_block;
+			if (p_new_block->next_ptr == NULL)
 			{
-				p_return = ((uint8_t *)p_block + SIZE_OF_BLOCK_HEADER);
-
-				mem_blk_header_t *p_new_block = (mem_blk_header_t *)(((uint8_t *)p_block) + SIZE_OF_BLOCK_HEADER + size);
-				p_new_block->size = p_block->size - size - SIZE_OF_BLOCK_HEADER;
-				p_new_block->state = MEM_STATE_FREE;
-				p_new_block->next_ptr = p_block->next_ptr;
-				if (p_new_block->next_ptr == NULL)
-				{
-					mem_blk_end_ptr = p_new_block;
-				}
-
-				p_block->size = size;
-				p_block->state = MEM_STATE_BUSY;
-				p_block->next_ptr = p_new_block;
-				// p_block = p_block->next_ptr;
-
-				byte_available -= (size + SIZE_OF_BLOCK_HEADER);
+				mem_blk_end_ptr = p_new_block;
 			}
-
 			else
 			{
-				p_return = ((uint8_t *)p_block + SIZE_OF_BLOCK_HEADER);
-				p_block->state = MEM_STATE_BUSY;
-				byte_available -= p_block->size;
+				p_new_block->next_ptr->prev_ptr = p_new_block;
 			}
-			return (void *)p_return;
+
+			p_block->size = size;
+			p_block->next_ptr = p_new_block;
+
+			byte_available -= (size + SIZE_OF_BLOCK_HEADER);
 		}
 		else
 		{
-			os_assert(0, "OS_ERR_MEM_BLOCK_NULL");
-			/* MEM_FAULT (p_block null) */
+			byte_available -= p_block->size;
 		}
+		p_block->state = MEM_STATE_BUSY;
 	}
 	return (void *) p_return;
 }
 
+/* Remove p_block->next_ptr from the heap by merging it into p_block */
+static void mem_merge_next(mem_blk_header_t *p_block)
+{
+	mem_blk_header_t *p_next = p_block->next_ptr;
+
+	byte_available += SIZE_OF_BLOCK_HEADER;
+
+	p_block->size += p_next->size + SIZE_OF_BLOCK_HEADER;
+	p_block->next_ptr = p_next->next_ptr;
+	if (p_block->next_ptr == NULL)
+	{
+		mem_blk_end_ptr = p_block;
+	}
+	else
+	{
+		p_block->next_ptr->prev_ptr = p_block;
+	}
+}
+
 void os_mem_free(void *p_addr)
 {
 	if (mem_blk_end_ptr == NULL)
@@ -150,49 +157,71 @@ void os_mem_free(void *p_addr)
 		{
 			return;
 		}
-		mem_blk_header_t *p_block_temp = &mem_blk_start;
-		mem_blk_header_t *p_prev_block = p_block_temp;
-
-		while (p_block_temp != mem_blk_end_ptr && (uint8_t *)p_block_temp != (uint8_t *)p_block)
+		/* Neighbours have to point back, else it is not a block start */
+		if ((p_block->next_ptr != NULL && p_block->next_ptr->prev_ptr != p_block) ||
+		    (p_block->prev_ptr != NULL && p_block->prev_ptr->next_ptr != p_block) ||
+		    (p_block->prev_ptr == NULL && p_block != mem_blk_start.next_ptr))
 		{
-			p_prev_block = p_block_temp;
-			p_block_temp = p_block_temp->next_ptr;
+			os_assert(0, "OS_ERR_MEM_INVALID_ADDRESS");
+			return; // Invalid address
 		}
-		if (p_block_temp != NULL)
+
+		byte_available += p_block->size;
+		p_block->state = MEM_STATE_FREE;
+
+		// Merge the next block
+		if (p_block->next_ptr != NULL && p_block->next_ptr->state == MEM_STATE_FREE)
 		{
-			byte_available += p_block_temp->size;
+			mem_merge_next(p_block);
+		}
 
-			p_block_temp->state = MEM_STATE_FREE;
+		// Merge the prev block
+		if (p_block->prev_ptr != NULL && p_block->prev_ptr->state == MEM_STATE_FREE)
+		{
+			mem_merge_next(p_block->prev_ptr);
+		}
+	}
+	return;
+}
 
-			// Merge the next block
-			if (p_block_temp->next_ptr != NULL && p_block_temp->next_ptr->state == MEM_STATE_FREE)
-			{
-				byte_available += SIZE_OF_BLOCK_HEADER;
-
-				p_block_temp->size += p_block_temp->next_ptr->size + SIZE_OF_BLOCK_HEADER;
-				p_block_temp->next_ptr = p_block_temp->next_ptr->next_ptr;
-				if (p_block_temp->next_ptr == NULL)
-				{
-					mem_blk_end_ptr = p_block_temp;
-				}
-			}
+uint32_t os_mem_get_byte_available(void)
+{
+	if (mem_blk_end_ptr == NULL)
+	{
+		os_mem_heap_init();
+	}
+	return byte_available;
+}
 
-			// Merge the prev block
-			if (p_prev_block->state == MEM_STATE_FREE && (uint8_t *)p_prev_block != (uint8_t*)&mem_blk_start)
-			{
-				byte_available += SIZE_OF_BLOCK_HEADER;
+uint8_t os_mem_check(void)
+{
+	mem_blk_header_t *p_block;
+	mem_blk_header_t *p_prev_block = NULL;
+	uint32_t byte_free = 0;
 
-				p_prev_block->size += p_block_temp->size + SIZE_OF_BLOCK_HEADER;
-				p_prev_block->next_ptr = p_block_temp->next_ptr;
-			}
-		}
-		else
+	if (mem_blk_end_ptr == NULL)
+	{
+		os_mem_heap_init();
+	}
+	for (p_block = mem_blk_start.next_ptr; p_block != NULL; p_block = p_block->next_ptr)
+	{
+		if ((uint8_t *)p_block < mem_heap || (uint8_t *)p_block + SIZE_OF_BLOCK_HEADER + p_block->size > mem_heap + OS_CFG_HEAP_SIZE)
+			return OS_FALSE; /* Out of heap */
+		if (p_block->prev_ptr != p_prev_block)
+			return OS_FALSE; /* Broken back link */
+		if (p_block->next_ptr != NULL && (uint8_t *)p_block->next_ptr != (uint8_t *)p_block + SIZE_OF_BLOCK_HEADER + p_block->size)
+			return OS_FALSE; /* Blocks are not contiguous */
+		if (p_block->state == MEM_STATE_FREE)
 		{
-			os_assert(0, "OS_ERR_MEM_INVALID_ADDRESS");
-			return; // Invalid address
+			if (p_prev_block != NULL && p_prev_block->state == MEM_STATE_FREE)
+				return OS_FALSE; /* Two free neighbours were not merged */
+			byte_free += p_block->size;
 		}
+		p_prev_block = p_block;
 	}
-	return;
+	if (p_prev_block != mem_blk_end_ptr || byte_free != byte_available)
+		return OS_FALSE;
+	return OS_TRUE;
 }
 
 #else
@@ -209,4 +238,15 @@ void os_mem_free(void * p_addr)
 	free(p_addr);
 	return;
 }
+
+uint32_t os_mem_get_byte_available(void)
+{
+	return 0;
+}
+
+uint8_t os_mem_check(void)
+{
+	return OS_TRUE;
+}
 #endif
+#endif /* OS_CFG_USE_MEM_TLSF == 0u */
@@ -0,0 +1,418 @@
+/*
+*********************************************************************************************************
+*                                     MEMORY MANAGEMENT (TLSF)
+*
+* File    : os_mem_tlsf.c
+* Version : none
+* Author  : JiaHui
+*
+* Two-Level Segregated Fit allocator, selected with OS_CFG_USE_MEM_TLSF.
+* Free blocks are kept in lists indexed by (first level = power of 2 of size,
+* second level = linear split of that range). Two bitmaps find a fitting list
+* with one bit scan each, and every block links its physical previous block,
+* so malloc and free are O(1) whatever the fragmentation.
+*********************************************************************************************************
+*/
+
+#include "os_cfg.h"
+#include "os_mem.h"
+#include "os_kernel.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if (OS_CFG_USE_MEM_TLSF == 1u)
+
+#define ALIGNMENT 		((size_t)sizeof(void *)) // must be a power of 2, 4 on Cortex-M3
+
+#define mem_align(size) 	(size_t)(((size) + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1))
+
+#define TLSF_SL_COUNT		((uint32_t)1u << OS_CFG_MEM_TLSF_SL_LOG2)
+#define TLSF_ALIGN_LOG2		((sizeof(void *) == 8u) ? 3u : 2u)
+#define TLSF_FL_SHIFT		(OS_CFG_MEM_TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_INDEX_MAX	(16u) // Largest block is below 2^16 bytes
+#define TLSF_FL_COUNT		(TLSF_FL_INDEX_MAX - TLSF_FL_SHIFT + 1u)
+#define TLSF_SMALL_SIZE		((size_t)1u << TLSF_FL_SHIFT) // Below it, sizes are split linearly in first level 0
+
+#if (OS_CFG_MEM_TLSF_SL_LOG2 > 5u)
+#error OS_CFG_MEM_TLSF_SL_LOG2 have to be 5 or less
+#endif
+
+#define BLOCK_FREE_BIT		((size_t)1u)
+#define BLOCK_PREV_FREE_BIT	((size_t)2u)
+#define BLOCK_SIZE_MASK		(~(BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT))
+
+typedef struct tlsf_block tlsf_block_t;
+
+struct tlsf_block
+{
+	tlsf_block_t *prev_phys_ptr;	// Block just before in memory
+	size_t size;			// Payload size, low bits are BLOCK_FREE_BIT/BLOCK_PREV_FREE_BIT
+	/* Payload starts here, these two are only used while block is free */
+	tlsf_block_t *next_free_ptr;
+	tlsf_block_t *prev_free_ptr;
+};
+
+#define SIZE_OF_BLOCK_HEADER 	((size_t)mem_align(2u * sizeof(void *))) // prev_phys_ptr + size
+#define BLOCK_SIZE_MIN		((size_t)(2u * sizeof(void *))) // Room for free list links
+#define SIZE_OF_END_BLOCK	((size_t)mem_align(sizeof(tlsf_block_t)))
+
+#define block_size(p_block)	((p_block)->size & BLOCK_SIZE_MASK)
+#define block_is_free(p_block)	(((p_block)->size & BLOCK_FREE_BIT) != 0u)
+#define block_payload(p_block)	((void *)((uint8_t *)(p_block) + SIZE_OF_BLOCK_HEADER))
+#define block_next(p_block)	((tlsf_block_t *)((uint8_t *)(p_block) + SIZE_OF_BLOCK_HEADER + block_size(p_block)))
+
+static uint8_t mem_heap[OS_CFG_HEAP_SIZE];
+static tlsf_block_t *mem_blk_first_ptr = NULL;
+static tlsf_block_t *mem_blk_end_ptr = NULL; // Zero size busy block closing the heap
+
+static uint32_t fl_bitmap;
+static uint32_t sl_bitmap[TLSF_FL_COUNT];
+static tlsf_block_t *free_blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+static uint32_t byte_available = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define tlsf_ffs(x) 		((uint32_t)__builtin_ctz(x))
+#define tlsf_fls(x) 		((uint32_t)(31 - __builtin_clz(x)))
+#else
+static uint32_t tlsf_ffs(uint32_t x)
+{
+	uint32_t bit = 0u;
+	while ((x & 1u) == 0u)
+	{
+		x >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+static uint32_t tlsf_fls(uint32_t x)
+{
+	uint32_t bit = 0u;
+	while (x >>= 1)
+	{
+		bit++;
+	}
+	return bit;
+}
+#endif
+
+static void tlsf_mapping(size_t size, uint32_t *p_fl, uint32_t *p_sl)
+{
+	uint32_t fl;
+	if (size < TLSF_SMALL_SIZE)
+	{
+		*p_fl = 0u;
+		*p_sl = (uint32_t)(size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT));
+	}
+	else
+	{
+		fl = tlsf_fls((uint32_t)size);
+		*p_sl = (uint32_t)(size >> (fl - OS_CFG_MEM_TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+		*p_fl = fl - (TLSF_FL_SHIFT - 1u);
+	}
+}
+
+/* Round size up to next list, so any block of that list fits */
+static void tlsf_mapping_search(size_t size, uint32_t *p_fl, uint32_t *p_sl)
+{
+	if (size >= TLSF_SMALL_SIZE)
+	{
+		size += ((size_t)1u << (tlsf_fls((uint32_t)size) - OS_CFG_MEM_TLSF_SL_LOG2)) - 1u;
+	}
+	tlsf_mapping(size, p_fl, p_sl);
+}
+
+static tlsf_block_t *tlsf_search_suitable_block(uint32_t *p_fl, uint32_t *p_sl)
+{
+	uint32_t fl = *p_fl;
+	uint32_t sl;
+	uint32_t sl_map;
+	uint32_t fl_map;
+
+	if (fl >= TLSF_FL_COUNT)
+	{
+		return NULL;
+	}
+	sl_map = sl_bitmap[fl] & (~(uint32_t)0u << *p_sl);
+	if (sl_map == 0u)
+	{
+		/* No block in this first level, take smallest of a larger one */
+		fl_map = (fl + 1u < 32u) ? (fl_bitmap & (~(uint32_t)0u << (fl + 1u))) : 0u;
+		if (fl_map == 0u)
+		{
+			return NULL;
+		}
+		fl = tlsf_ffs(fl_map);
+		sl_map = sl_bitmap[fl];
+	}
+	sl = tlsf_ffs(sl_map);
+	*p_fl = fl;
+	*p_sl = sl;
+	return free_blocks[fl][sl];
+}
+
+static void tlsf_remove_free_block(tlsf_block_t *p_block, uint32_t fl, uint32_t sl)
+{
+	tlsf_block_t *p_prev = p_block->prev_free_ptr;
+	tlsf_block_t *p_next = p_block->next_free_ptr;
+
+	if (p_next != NULL)
+	{
+		p_next->prev_free_ptr = p_prev;
+	}
+	if (p_prev != NULL)
+	{
+		p_prev->next_free_ptr = p_next;
+	}
+	else
+	{
+		free_blocks[fl][sl] = p_next;
+		if (p_next == NULL)
+		{
+			sl_bitmap[fl] &= ~((uint32_t)1u << sl);
+			if (sl_bitmap[fl] == 0u)
+			{
+				fl_bitmap &= ~((uint32_t)1u << fl);
+			}
+		}
+	}
+}
+
+static void tlsf_insert_free_block(tlsf_block_t *p_block)
+{
+	uint32_t fl;
+	uint32_t sl;
+	tlsf_mapping(block_size(p_block), &fl, &sl);
+
+	p_block->prev_free_ptr = NULL;
+	p_block->next_free_ptr = free_blocks[fl][sl];
+	if (free_blocks[fl][sl] != NULL)
+	{
+		free_blocks[fl][sl]->prev_free_ptr = p_block;
+	}
+	free_blocks[fl][sl] = p_block;
+	fl_bitmap |= (uint32_t)1u << fl;
+	sl_bitmap[fl] |= (uint32_t)1u << sl;
+}
+
+static void tlsf_unlink_block(tlsf_block_t *p_block)
+{
+	uint32_t fl;
+	uint32_t sl;
+	tlsf_mapping(block_size(p_block), &fl, &sl);
+	tlsf_remove_free_block(p_block, fl, sl);
+}
+
+static void os_mem_heap_init(void)
+{
+	uint32_t total_heap_size = OS_CFG_HEAP_SIZE;
+	uintptr_t heap_addr = (uintptr_t)mem_heap;
+	os_assert(OS_CFG_HEAP_SIZE < ((size_t)1u << TLSF_FL_INDEX_MAX), "OS_ERR_MEM_HEAP_TOO_BIG");
+	if ((heap_addr & (ALIGNMENT - 1)) != 0) /* If address of heap memory is not alligned	*/
+	{
+		heap_addr += (ALIGNMENT - 1);
+		heap_addr &= ~((uintptr_t)ALIGNMENT - 1);
+		total_heap_size -= heap_addr - (uintptr_t)mem_heap; /* Recalculate size of heap memory	*/
+	}
+	total_heap_size &= ~((uint32_t)ALIGNMENT - 1);
+
+	/* One free block over the whole heap, then the end block */
+	mem_blk_first_ptr = (tlsf_block_t *)heap_addr;
+	mem_blk_first_ptr->prev_phys_ptr = NULL;
+	mem_blk_first_ptr->size = (total_heap_size - SIZE_OF_BLOCK_HEADER - SIZE_OF_END_BLOCK) | BLOCK_FREE_BIT;
+
+	mem_blk_end_ptr = block_next(mem_blk_first_ptr);
+	mem_blk_end_ptr->prev_phys_ptr = mem_blk_first_ptr;
+	mem_blk_end_ptr->size = BLOCK_PREV_FREE_BIT;
+
+	tlsf_insert_free_block(mem_blk_first_ptr);
+
+	byte_available = block_size(mem_blk_first_ptr);
+}
+
+void *os_mem_malloc(size_t size)
+{
+	tlsf_block_t *p_block;
+	tlsf_block_t *p_rest;
+	uint32_t fl;
+	uint32_t sl;
+
+	if (mem_blk_end_ptr == NULL)
+	{
+		os_mem_heap_init();
+	}
+	size = mem_align(size);
+	if (size == 0 || size > byte_available)
+	{
+		os_assert(0, "OS_ERR_MEM_INVALID_SIZE");
+		return NULL; // Invalid size
+	}
+	if (size < BLOCK_SIZE_MIN)
+	{
+		size = BLOCK_SIZE_MIN;
+	}
+
+	tlsf_mapping_search(size, &fl, &sl);
+	p_block = tlsf_search_suitable_block(&fl, &sl);
+	if (p_block == NULL)
+	{
+		/* Rounding up may skip the only big enough block, its list head is still O(1) to check */
+		tlsf_mapping(size, &fl, &sl);
+		if (fl < TLSF_FL_COUNT && free_blocks[fl][sl] != NULL && block_size(free_blocks[fl][sl]) >= size)
+		{
+			p_block = free_blocks[fl][sl];
+		}
+	}
+	if (p_block == NULL)
+	{
+		os_assert(0, "OS_ERR_MEM_NO_BLOCK");
+		return NULL; // No block available
+	}
+	tlsf_remove_free_block(p_block, fl, sl);
+
+	if (block_size(p_block) >= (size + SIZE_OF_BLOCK_HEADER + BLOCK_SIZE_MIN))
+	{
+		/* Split, rest of block goes back to free lists */
+		p_rest = (tlsf_block_t *)((uint8_t *)block_payload(p_block) + size);
+		p_rest->prev_phys_ptr = p_block;
+		p_rest->size = (block_size(p_block) - size - SIZE_OF_BLOCK_HEADER) | BLOCK_FREE_BIT;
+		block_next(p_rest)->prev_phys_ptr = p_rest; /* Next block keeps its prev free bit */
+		tlsf_insert_free_block(p_rest);
+
+		p_block->size = size | (p_block->size & BLOCK_PREV_FREE_BIT);
+		byte_available -= (size + SIZE_OF_BLOCK_HEADER);
+	}
+	else
+	{
+		p_block->size &= ~BLOCK_FREE_BIT;
+		block_next(p_block)->size &= ~BLOCK_PREV_FREE_BIT;
+		byte_available -= block_size(p_block);
+	}
+	return block_payload(p_block);
+}
+
+void os_mem_free(void *p_addr)
+{
+	tlsf_block_t *p_block;
+	tlsf_block_t *p_neighbour;
+
+	if (mem_blk_end_ptr == NULL)
+	{
+		os_mem_heap_init();
+	}
+	if ((uint8_t *)p_addr < (uint8_t *)block_payload(mem_blk_first_ptr) ||
+	    (uint8_t *)p_addr >= (uint8_t *)mem_blk_end_ptr)
+	{
+		os_assert(0, "OS_ERR_MEM_INVALID_ADDRESS");
+		return; // Invalid address
+	}
+
+	p_block = (tlsf_block_t *)((uint8_t *)p_addr - SIZE_OF_BLOCK_HEADER);
+	if (block_is_free(p_block))
+	{
+		return;
+	}
+	byte_available += block_size(p_block);
+
+	/* Merge the prev block */
+	if ((p_block->size & BLOCK_PREV_FREE_BIT) != 0u)
+	{
+		p_neighbour = p_block->prev_phys_ptr;
+		tlsf_unlink_block(p_neighbour);
+		p_neighbour->size += block_size(p_block) + SIZE_OF_BLOCK_HEADER; /* Keeps its flags */
+		p_block = p_neighbour;
+		byte_available += SIZE_OF_BLOCK_HEADER;
+	}
+
+	/* Merge the next block */
+	p_neighbour = block_next(p_block);
+	if (block_is_free(p_neighbour))
+	{
+		tlsf_unlink_block(p_neighbour);
+		p_block->size += block_size(p_neighbour) + SIZE_OF_BLOCK_HEADER;
+		byte_available += SIZE_OF_BLOCK_HEADER;
+	}
+
+	p_block->size |= BLOCK_FREE_BIT;
+	p_neighbour = block_next(p_block);
+	p_neighbour->prev_phys_ptr = p_block;
+	p_neighbour->size |= BLOCK_PREV_FREE_BIT;
+	tlsf_insert_free_block(p_block);
+}
+
+uint32_t os_mem_get_byte_available(void)
+{
+	if (mem_blk_end_ptr == NULL)
+	{
+		os_mem_heap_init();
+	}
+	return byte_available;
+}
+
+uint8_t os_mem_check(void)
+{
+	tlsf_block_t *p_block;
+	uint8_t prev_free = OS_FALSE;
+	uint32_t byte_free = 0;
+	uint32_t num_of_free = 0;
+	uint32_t fl, sl, check_fl, check_sl;
+
+	if (mem_blk_end_ptr == NULL)
+	{
+		os_mem_heap_init();
+	}
+
+	/* Physical walk */
+	for (p_block = mem_blk_first_ptr; p_block != mem_blk_end_ptr; p_block = block_next(p_block))
+	{
+		if ((uint8_t *)block_next(p_block) > (uint8_t *)mem_blk_end_ptr)
+			return OS_FALSE; /* Out of heap */
+		if (((p_block->size & BLOCK_PREV_FREE_BIT) != 0u) != (prev_free == OS_TRUE))
+			return OS_FALSE; /* Stale prev free flag */
+		if (block_is_free(p_block))
+		{
+			if (prev_free == OS_TRUE)
+				return OS_FALSE; /* Two free neighbours were not merged */
+			if (block_next(p_block)->prev_phys_ptr != p_block)
+				return OS_FALSE; /* Broken back link */
+			byte_free += block_size(p_block);
+			num_of_free++;
+			prev_free = OS_TRUE;
+		}
+		else
+		{
+			prev_free = OS_FALSE;
+		}
+	}
+	if (((p_block->size & BLOCK_PREV_FREE_BIT) != 0u) != (prev_free == OS_TRUE) || byte_free != byte_available)
+		return OS_FALSE;
+
+	/* Free lists, every free block has to be on list of its size class */
+	for (fl = 0; fl < TLSF_FL_COUNT; fl++)
+	{
+		if (((fl_bitmap >> fl) & 1u) != (sl_bitmap[fl] != 0u ? 1u : 0u))
+			return OS_FALSE;
+		for (sl = 0; sl < TLSF_SL_COUNT; sl++)
+		{
+			if (((sl_bitmap[fl] >> sl) & 1u) != (free_blocks[fl][sl] != NULL ? 1u : 0u))
+				return OS_FALSE;
+			for (p_block = free_blocks[fl][sl]; p_block != NULL; p_block = p_block->next_free_ptr)
+			{
+				if (!block_is_free(p_block) || num_of_free == 0u)
+					return OS_FALSE;
+				if (p_block->next_free_ptr != NULL && p_block->next_free_ptr->prev_free_ptr != p_block)
+					return OS_FALSE;
+				tlsf_mapping(block_size(p_block), &check_fl, &check_sl);
+				if (check_fl != fl || check_sl != sl)
+					return OS_FALSE;
+				num_of_free--;
+			}
+		}
+	}
+	if (num_of_free != 0u)
+		return OS_FALSE; /* Free block missing from lists */
+	return OS_TRUE;
+}
+
+#endif /* OS_CFG_USE_MEM_TLSF == 1u */
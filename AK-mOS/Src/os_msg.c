@@ -1,94 +1,363 @@
 #include "os_msg.h"
 #include "os_mem.h"
+#include "os_pool.h"
 #include "os_kernel.h"
+#include "os_task.h"
 
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-static msg_t msg_pool[OS_CFG_MSG_POOL_SIZE];
-static msg_t *free_list_msg_pool;
-static uint8_t msg_pool_used;
+#define MSG_PAYLOAD_HEAP                ((uint8_t)0xFFu)
+#define MSG_PAYLOAD_INLINE              ((uint8_t)0xFEu) /* Kept in msg_t itself */
+#define MSG_PAYLOAD_LOAN                ((uint8_t)0xFDu) /* Loaned buffer, source is in its header */
 
-static void msg_pool_init(void)
+#define MSG_LOAN_MAGIC                  ((uint8_t)0xA5u)
+
+/* Put just before a loaned buffer */
+typedef union
 {
-    ENTER_CRITICAL();
+    struct
+    {
+        uint16_t size;
+        uint8_t src;       /* Pool class or heap, as payload_src */
+        uint8_t magic;     /* MSG_LOAN_MAGIC while buffer is loaned or posted */
+        uint8_t ref_count; /* Owners: sender, or every msg sharing it */
+    } info;
+    void *align; /* Buffer after header stays aligned */
+} msg_loan_hdr_t;
+
+static msg_t msg_pool_buf[OS_CFG_MSG_POOL_SIZE];
+static pool_t msg_pool;
+
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
+static const uint16_t msg_payload_size[] = OS_CFG_MSG_PAYLOAD_SIZES;
+static const uint16_t msg_payload_num[] = OS_CFG_MSG_PAYLOAD_NUMS;
+
+#define MSG_PAYLOAD_CLASS_NUM           ((uint8_t)(sizeof(msg_payload_size) / sizeof(msg_payload_size[0])))
+
+static pool_t msg_payload_pool[MSG_PAYLOAD_CLASS_NUM];
+static uint32_t msg_payload_hit[MSG_PAYLOAD_CLASS_NUM];
+static uint32_t msg_payload_miss[MSG_PAYLOAD_CLASS_NUM];
+#endif
+
+/* Called in critical section */
+static void *msg_block_alloc(uint16_t size, uint8_t *p_src)
+{
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
     uint8_t index;
+    void *p_payload;
 
-    free_list_msg_pool = (msg_t *)msg_pool;
-
-    for (index = 0; index < OS_CFG_MSG_POOL_SIZE; index++)
+    for (index = 0; index < MSG_PAYLOAD_CLASS_NUM; index++)
     {
-        if (index == (OS_CFG_MSG_POOL_SIZE - 1))
-        {
-            msg_pool[index].next = NULL;
-        }
-        else
+        if (size <= msg_payload_size[index])
         {
-            msg_pool[index].next = (msg_t *)&msg_pool[index + 1];
+            p_payload = os_pool_get(&msg_payload_pool[index]);
+            if (p_payload != NULL)
+            {
+                msg_payload_hit[index]++;
+                *p_src = index;
+                return p_payload;
+            }
+            msg_payload_miss[index]++;
+            break;
         }
     }
+#endif
+    *p_src = MSG_PAYLOAD_HEAP;
+    return os_mem_malloc(size);
+}
 
-    msg_pool_used = 0;
-
+static void msg_block_free(void *p_block, uint8_t src)
+{
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
+    if (src != MSG_PAYLOAD_HEAP)
+    {
+        os_pool_put(&msg_payload_pool[src], p_block);
+        return;
+    }
+#else
+    (void)src;
+#endif
+    ENTER_CRITICAL();
+    os_mem_free(p_block);
     EXIT_CRITICAL();
 }
+
+/* Called in critical section, sets where payload of p_msg comes from */
+static uint8_t *msg_payload_alloc(msg_t *p_msg, uint8_t size)
+{
+#if (OS_CFG_MSG_INLINE_SIZE > 0u)
+    if (size <= OS_CFG_MSG_INLINE_SIZE)
+    {
+        p_msg->payload_src = MSG_PAYLOAD_INLINE;
+        return p_msg->inline_buf.data;
+    }
+#endif
+    return (uint8_t *)msg_block_alloc(size, &(p_msg->payload_src));
+}
+
+static msg_loan_hdr_t *msg_loan_get_hdr(void *p_buf)
+{
+    msg_loan_hdr_t *p_hdr;
+    if (p_buf == NULL)
+    {
+        // OSUniversalError = OS_ERR_MSG_LOAN_INVALID;
+        os_assert(0, "OS_ERR_MSG_LOAN_INVALID");
+        return NULL;
+    }
+    p_hdr = (msg_loan_hdr_t *)p_buf - 1;
+    if (p_hdr->info.magic != MSG_LOAN_MAGIC)
+    {
+        // OSUniversalError = OS_ERR_MSG_LOAN_INVALID;
+        os_assert(0, "OS_ERR_MSG_LOAN_INVALID");
+        return NULL;
+    }
+    return p_hdr;
+}
+
+static void msg_payload_free(msg_t *p_msg)
+{
+    switch (p_msg->payload_src)
+    {
+    case MSG_PAYLOAD_INLINE:
+        break;
+    case MSG_PAYLOAD_LOAN:
+        os_msg_loan_return(p_msg->content_ptr);
+        break;
+    default:
+        msg_block_free(p_msg->content_ptr, p_msg->payload_src);
+        break;
+    }
+}
+
 void os_msg_init(void)
 {
-    msg_pool_init();
+    os_pool_create(&msg_pool, msg_pool_buf, sizeof(msg_t), OS_CFG_MSG_POOL_SIZE);
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
+    uint8_t index;
+    size_t pool_bytes = 0u;
+    if (sizeof(msg_payload_num) != sizeof(msg_payload_size))
+    {
+        // OSUniversalError = OS_ERR_MSG_PAYLOAD_CFG_INVALID;
+        os_assert(0, "OS_ERR_MSG_PAYLOAD_CFG_INVALID");
+        return;
+    }
+    for (index = 0; index < MSG_PAYLOAD_CLASS_NUM; index++)
+    {
+        pool_bytes += OS_POOL_BLK_SIZE(msg_payload_size[index]) * msg_payload_num[index] + sizeof(mem_blk_header_t);
+    }
+    if (pool_bytes > os_mem_get_byte_available())
+    {
+        /* Pools are taken before any task, a heap too small for them can not hold tasks either */
+        // OSUniversalError = OS_ERR_MSG_PAYLOAD_POOL_NO_MEM;
+        os_assert(0, "OS_ERR_MSG_PAYLOAD_POOL_NO_MEM");
+        return; /* No class pool, every payload is taken from heap */
+    }
+    for (index = 0; index < MSG_PAYLOAD_CLASS_NUM; index++)
+    {
+        os_pool_create(&msg_payload_pool[index], NULL, msg_payload_size[index], msg_payload_num[index]);
+        msg_payload_hit[index] = 0u;
+        msg_payload_miss[index] = 0u;
+    }
+#endif
 }
 
 void os_msg_free(msg_t *p_msg)
 {
+    if (p_msg->type == MSG_TYPE_DYNAMIC)
+    {
+        msg_payload_free(p_msg);
+    }
+    os_pool_put(&msg_pool, p_msg);
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u) || (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    os_task_wake_msg_pool_waiter(); /* A sender, or a receiver with a pending signal, may wait for a free msg */
+#endif
+}
+
+void os_msg_free_chain(msg_t *p_msg)
+{
+    msg_t *p_msg_head = p_msg;
+    uint16_t num = 0u;
+
+    while (p_msg != NULL)
+    {
+        if (p_msg->type == MSG_TYPE_DYNAMIC)
+        {
+            msg_payload_free(p_msg);
+        }
+        num++;
+        p_msg = p_msg->next;
+    }
+    /* next is first member of msg_t, chain is already linked the way pool links free blocks */
+    os_pool_put_chain(&msg_pool, p_msg_head, num);
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u) || (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    while (num-- != 0u)
+    {
+        os_task_wake_msg_pool_waiter();
+    }
+#endif
+}
+
+void os_msg_get_pool_stats(pool_stats_t *p_stats)
+{
+    os_pool_get_stats(&msg_pool, p_stats);
+}
+
+uint16_t os_msg_get_pool_free(void)
+{
+    return (uint16_t)(msg_pool.blk_num - msg_pool.used);
+}
+
+void *os_msg_loan(uint16_t size)
+{
+    msg_loan_hdr_t *p_hdr;
+    uint8_t src;
+
+    if (size == 0u || size > (uint16_t)(0xFFFFu - sizeof(msg_loan_hdr_t)))
+    {
+        // OSUniversalError = OS_ERR_MSG_LOAN_INVALID_SIZE;
+        os_assert(0, "OS_ERR_MSG_LOAN_INVALID_SIZE");
+        return NULL;
+    }
     ENTER_CRITICAL();
+    p_hdr = (msg_loan_hdr_t *)msg_block_alloc((uint16_t)(size + sizeof(msg_loan_hdr_t)), &src);
+    EXIT_CRITICAL();
+    if (p_hdr == NULL)
+    {
+        return NULL;
+    }
+    p_hdr->info.size = size;
+    p_hdr->info.src = src;
+    p_hdr->info.magic = MSG_LOAN_MAGIC;
+    p_hdr->info.ref_count = 1u;
+    return (void *)(p_hdr + 1);
+}
 
-    p_msg->next = free_list_msg_pool;
-    free_list_msg_pool = p_msg;
-    if (p_msg->type == MSG_TYPE_DYNAMIC)
+void os_msg_loan_add_ref(void *p_buf, uint8_t count)
+{
+    ENTER_CRITICAL();
+    msg_loan_hdr_t *p_hdr = msg_loan_get_hdr(p_buf);
+    if (p_hdr != NULL)
     {
-        os_mem_free(p_msg->content_ptr);
+        if ((uint16_t)p_hdr->info.ref_count + count > 0xFFu)
+        {
+            // OSUniversalError = OS_ERR_MSG_LOAN_REF_OVERFLOW;
+            os_assert(0, "OS_ERR_MSG_LOAN_REF_OVERFLOW");
+        }
+        else
+        {
+            p_hdr->info.ref_count += count;
+        }
     }
-    msg_pool_used--;
+    EXIT_CRITICAL();
+}
 
+void os_msg_loan_return(void *p_buf)
+{
+    ENTER_CRITICAL();
+    msg_loan_hdr_t *p_hdr = msg_loan_get_hdr(p_buf);
+    if (p_hdr == NULL)
+    {
+        EXIT_CRITICAL();
+        return;
+    }
+    p_hdr->info.ref_count--;
+    if (p_hdr->info.ref_count == 0u)
+    {
+        /* Last owner */
+        p_hdr->info.magic = 0u;
+        msg_block_free(p_hdr, p_hdr->info.src);
+    }
     EXIT_CRITICAL();
 }
 
+#if (OS_CFG_USE_MSG_PAYLOAD_POOL == 1u)
+uint8_t os_msg_get_payload_class_num(void)
+{
+    return MSG_PAYLOAD_CLASS_NUM;
+}
+
+void os_msg_get_payload_stats(uint8_t class_idx, msg_payload_stats_t *p_stats)
+{
+    pool_stats_t pool_stats;
+    if (class_idx >= MSG_PAYLOAD_CLASS_NUM)
+    {
+        // OSUniversalError = OS_ERR_MSG_PAYLOAD_CLASS_INVALID;
+        os_assert(0, "OS_ERR_MSG_PAYLOAD_CLASS_INVALID");
+        return;
+    }
+    os_pool_get_stats(&msg_payload_pool[class_idx], &pool_stats);
+    p_stats->size = msg_payload_size[class_idx];
+    p_stats->blk_num = pool_stats.blk_num;
+    p_stats->used = pool_stats.used;
+    p_stats->used_max = pool_stats.used_max;
+    ENTER_CRITICAL();
+    p_stats->hit = msg_payload_hit[class_idx];
+    p_stats->miss = msg_payload_miss[class_idx];
+    EXIT_CRITICAL();
+}
+#endif
+
 void os_msg_queue_init(msg_queue_t *p_msg_q,
-                       uint8_t size)
+                       uint8_t size,
+                       msg_q_policy_t policy)
 {
     p_msg_q->head_ptr = NULL;
     p_msg_q->tail_ptr = NULL;
-    p_msg_q->size_max = size;
+    p_msg_q->size_max = (policy == MSG_Q_MAILBOX && size != 0u) ? 1u : size;
     p_msg_q->size_curr = 0u;
+    p_msg_q->policy = policy;
+    p_msg_q->num_dropped = 0u;
 }
 
-void os_msg_queue_put_dynamic(msg_queue_t *p_msg_q,
-                              int32_t sig,
-                              void *p_content,
-                              uint8_t size)
+/* Called in critical section. Gives a msg to be filled and appended to queue,
+NULL if queue takes no more msg. On a full queue, its policy tells what to do */
+static msg_t *msg_queue_take_slot(msg_queue_t *p_msg_q)
 {
-    ENTER_CRITICAL();
     msg_t *p_msg;
-    msg_t *p_msg_tail;
     if (p_msg_q->size_curr >= p_msg_q->size_max)
     {
-        // OSUniversalError = OS_ERR_MSG_QUEUE_IS_FULL;
-        os_assert(0, "OS_ERR_MSG_QUEUE_IS_FULL");
-        EXIT_CRITICAL();
-        return;
+        switch (p_msg_q->policy)
+        {
+        case MSG_Q_OVERFLOW_DROP_OLDEST:
+        case MSG_Q_MAILBOX:
+            if (p_msg_q->size_curr != 0u)
+            {
+                /* Oldest msg is recycled for the new one, no alloc */
+                p_msg = os_msg_queue_get(p_msg_q);
+                if (p_msg->type == MSG_TYPE_DYNAMIC)
+                {
+                    msg_payload_free(p_msg);
+                }
+                p_msg_q->num_dropped++;
+                return p_msg;
+            }
+            p_msg_q->num_dropped++;
+            return NULL;
+        case MSG_Q_OVERFLOW_DROP_NEWEST:
+            p_msg_q->num_dropped++;
+            return NULL;
+        default:
+            // OSUniversalError = OS_ERR_MSG_QUEUE_IS_FULL;
+            os_assert(0, "OS_ERR_MSG_QUEUE_IS_FULL");
+            return NULL;
+        }
     }
-    if (msg_pool_used >= OS_CFG_MSG_POOL_SIZE)
+    p_msg = (msg_t *)os_pool_get(&msg_pool);
+    if (p_msg == NULL)
     {
+        /* This states that u forget to free msg somewhere.*/
         // OSUniversalError = OS_ERR_MSG_POOL_IS_FULL;
         os_assert(0, "OS_ERR_MSG_POOL_IS_FULL");
-        EXIT_CRITICAL();
-        return;
     }
+    return p_msg;
+}
 
-    p_msg = free_list_msg_pool;
-    free_list_msg_pool = p_msg->next;
-    msg_pool_used++;
-
+/* Called in critical section */
+static void msg_queue_append(msg_queue_t *p_msg_q, msg_t *p_msg)
+{
+    msg_t *p_msg_tail;
     if (p_msg_q->size_curr == 0u) /* Is this first message placed in the queue? */
     {
         p_msg_q->head_ptr = p_msg; /* Yes */
@@ -105,62 +374,107 @@ void os_msg_queue_put_dynamic(msg_queue_t *p_msg_q,
 
         p_msg_q->size_curr++;
     }
+#if (OS_CFG_USE_MSG_RPC == 1u)
+    p_msg->src_task_id = MSG_TASK_ID_NONE; /* Not a call unless caller says so */
+#endif
+}
+
+msg_t *os_msg_queue_put_dynamic(msg_queue_t *p_msg_q,
+                                int32_t sig,
+                                void *p_content,
+                                uint8_t size)
+{
+    ENTER_CRITICAL();
+    msg_t *p_msg = msg_queue_take_slot(p_msg_q);
+    if (p_msg == NULL)
+    {
+        EXIT_CRITICAL();
+        return NULL;
+    }
+    p_msg->content_ptr = msg_payload_alloc(p_msg, size);
+    if (p_msg->content_ptr == NULL)
+    {
+        os_pool_put(&msg_pool, p_msg);
+        EXIT_CRITICAL();
+        return NULL;
+    }
 
     p_msg->type = MSG_TYPE_DYNAMIC;
     p_msg->sig = sig;
     p_msg->size = size;
-    p_msg->content_ptr = (uint8_t *)os_mem_malloc(size);
     memcpy(p_msg->content_ptr, p_content, size);
+    msg_queue_append(p_msg_q, p_msg);
 
     EXIT_CRITICAL();
+    return p_msg;
 }
 
-void os_msg_queue_put_pure(msg_queue_t *p_msg_q, int32_t sig)
+void os_msg_queue_put_loaned(msg_queue_t *p_msg_q, int32_t sig, void *p_buf)
 {
     ENTER_CRITICAL();
     msg_t *p_msg;
-    msg_t *p_msg_tail;
-    if (p_msg_q->size_curr >= p_msg_q->size_max)
+    msg_loan_hdr_t *p_hdr = msg_loan_get_hdr(p_buf);
+    if (p_hdr == NULL)
     {
-        // OSUniversalError = OS_ERR_MSG_QUEUE_IS_FULL;
-        os_assert(0, "OS_ERR_MSG_QUEUE_IS_FULL");
         EXIT_CRITICAL();
         return;
     }
-    if (msg_pool_used >= OS_CFG_MSG_POOL_SIZE)
+    p_msg = msg_queue_take_slot(p_msg_q);
+    if (p_msg == NULL)
     {
-        /* This states that u forget to free msg somewhere.*/
-        // OSUniversalError = OS_ERR_MSG_POOL_IS_FULL;
-        os_assert(0, "OS_ERR_MSG_POOL_IS_FULL");
+        os_msg_loan_return(p_buf); /* Ownership was given, do not leak it */
         EXIT_CRITICAL();
         return;
     }
 
-    p_msg = free_list_msg_pool;
-    free_list_msg_pool = p_msg->next;
-    msg_pool_used++;
+    /* No copy, receiver gets the buffer itself */
+    p_msg->type = MSG_TYPE_DYNAMIC;
+    p_msg->payload_src = MSG_PAYLOAD_LOAN;
+    p_msg->sig = sig;
+    p_msg->size = p_hdr->info.size;
+    p_msg->content_ptr = (uint8_t *)p_buf;
+    msg_queue_append(p_msg_q, p_msg);
 
-    if (p_msg_q->size_curr == 0u) /* Is this first message placed in the queue? */
-    {
-        p_msg_q->head_ptr = p_msg; /* Yes */
-        p_msg_q->tail_ptr = p_msg;
-        p_msg_q->size_curr = 1u;
-        p_msg->next = NULL;
-    }
-    else
-    {
-        p_msg_tail = p_msg_q->tail_ptr;
-        p_msg_tail->next = p_msg;
-        p_msg_q->tail_ptr = p_msg;
-        p_msg->next = NULL;
+    EXIT_CRITICAL();
+}
 
-        p_msg_q->size_curr++;
+msg_t *os_msg_queue_put_pure(msg_queue_t *p_msg_q, int32_t sig)
+{
+    ENTER_CRITICAL();
+    msg_t *p_msg = msg_queue_take_slot(p_msg_q);
+    if (p_msg == NULL)
+    {
+        EXIT_CRITICAL();
+        return NULL;
     }
 
     p_msg->type = MSG_TYPE_PURE;
     p_msg->sig = sig;
+    msg_queue_append(p_msg_q, p_msg);
 
     EXIT_CRITICAL();
+    return p_msg;
+}
+
+msg_t *os_msg_make_pure(int32_t sig)
+{
+    msg_t *p_msg = (msg_t *)os_pool_get(&msg_pool);
+    if (p_msg == NULL)
+    {
+        return NULL; /* Caller decides, a coalesced signal just stays pending */
+    }
+    p_msg->type = MSG_TYPE_PURE;
+    p_msg->sig = sig;
+    p_msg->next = NULL;
+#if (OS_CFG_USE_MSG_RPC == 1u)
+    p_msg->src_task_id = MSG_TASK_ID_NONE;
+#endif
+    return p_msg;
+}
+
+uint32_t os_msg_queue_get_dropped(msg_queue_t *p_msg_q)
+{
+    return p_msg_q->num_dropped;
 }
 
 msg_t *os_msg_queue_get(msg_queue_t *p_msg_q)
@@ -192,8 +506,54 @@ msg_t *os_msg_queue_get(msg_queue_t *p_msg_q)
     return (p_msg);
 }
 
+msg_t *os_msg_queue_get_match(msg_queue_t *p_msg_q, msg_match_t pf_match, void *p_arg)
+{
+    msg_t *p_msg = p_msg_q->head_ptr;
+    msg_t *p_msg_prev = NULL;
+
+    while (p_msg != NULL)
+    {
+        if (pf_match(p_msg, p_arg) == OS_TRUE)
+        {
+            if (p_msg_prev == NULL)
+            {
+                p_msg_q->head_ptr = p_msg->next;
+            }
+            else
+            {
+                p_msg_prev->next = p_msg->next;
+            }
+            if (p_msg_q->tail_ptr == p_msg)
+            {
+                p_msg_q->tail_ptr = p_msg_prev;
+            }
+            p_msg_q->size_curr--;
+            p_msg->next = NULL;
+            return p_msg;
+        }
+        p_msg_prev = p_msg;
+        p_msg = p_msg->next;
+    }
+    return NULL;
+}
+
 void *os_msg_get_dynamic_data(msg_t *p_msg,
                               uint8_t *p_msg_size)
+{
+    if (p_msg->size > 0xFFu)
+    {
+        /* Loaned msg bigger than 255 bytes, size does not fit, read it with os_msg_get_data */
+        // OSUniversalError = OS_ERR_MSG_SIZE_TOO_BIG;
+        os_assert(0, "OS_ERR_MSG_SIZE_TOO_BIG");
+        *p_msg_size = 0u;
+        return NULL;
+    }
+    *p_msg_size = (uint8_t)p_msg->size;
+    return p_msg->content_ptr;
+}
+
+void *os_msg_get_data(msg_t *p_msg,
+                      uint16_t *p_msg_size)
 {
     *p_msg_size = p_msg->size;
     return p_msg->content_ptr;
@@ -0,0 +1,162 @@
+#include "os_pool.h"
+#include "os_mem.h"
+#include "os_kernel.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define pool_blk_next(p_blk)    (*(void **)(p_blk))
+
+void os_pool_create(pool_t *p_pool, void *p_buf, size_t blk_size, uint16_t blk_num)
+{
+    uint16_t index;
+    uint8_t *p_blk;
+
+    memset(p_pool, 0, sizeof(pool_t));
+    p_pool->blk_size = OS_POOL_BLK_SIZE(blk_size);
+
+    if (blk_num == 0u)
+    {
+        // OSUniversalError = OS_ERR_POOL_INVALID_SIZE;
+        os_assert(0, "OS_ERR_POOL_INVALID_SIZE");
+        return;
+    }
+    if (p_buf == NULL)
+    {
+        p_buf = os_mem_malloc(p_pool->blk_size * blk_num);
+        if (p_buf == NULL)
+        {
+            // OSUniversalError = OS_ERR_POOL_NOT_ENOUGH_MEM_ALLOC;
+            os_assert(0, "OS_ERR_POOL_NOT_ENOUGH_MEM_ALLOC");
+            return;
+        }
+        p_pool->is_heap = OS_TRUE;
+    }
+    if (((uintptr_t)p_buf & (sizeof(void *) - 1u)) != 0u)
+    {
+        // OSUniversalError = OS_ERR_POOL_BUF_NOT_ALIGNED;
+        os_assert(0, "OS_ERR_POOL_BUF_NOT_ALIGNED");
+        return;
+    }
+
+    p_pool->buf_ptr = (uint8_t *)p_buf;
+    p_pool->blk_num = blk_num;
+
+    /* Link blocks in address order */
+    p_blk = p_pool->buf_ptr;
+    for (index = 0; index < (blk_num - 1u); index++)
+    {
+        pool_blk_next(p_blk) = p_blk + p_pool->blk_size;
+        p_blk += p_pool->blk_size;
+    }
+    pool_blk_next(p_blk) = NULL;
+
+    p_pool->free_list_ptr = p_pool->buf_ptr;
+}
+
+void os_pool_delete(pool_t *p_pool)
+{
+    if (p_pool->used != 0u)
+    {
+        // OSUniversalError = OS_ERR_POOL_IN_USE;
+        os_assert(0, "OS_ERR_POOL_IN_USE");
+        return;
+    }
+    if (p_pool->is_heap == OS_TRUE)
+    {
+        os_mem_free(p_pool->buf_ptr);
+    }
+    memset(p_pool, 0, sizeof(pool_t));
+}
+
+void *os_pool_get(pool_t *p_pool)
+{
+    void *p_blk;
+
+    ENTER_CRITICAL();
+    p_blk = p_pool->free_list_ptr;
+    if (p_blk == NULL)
+    {
+        p_pool->get_fail++;
+        EXIT_CRITICAL();
+        return NULL;
+    }
+    p_pool->free_list_ptr = pool_blk_next(p_blk);
+    p_pool->used++;
+    if (p_pool->used > p_pool->used_max)
+    {
+        p_pool->used_max = p_pool->used;
+    }
+    EXIT_CRITICAL();
+
+    return p_blk;
+}
+
+static uint8_t pool_blk_is_valid(pool_t *p_pool, void *p_blk)
+{
+    size_t offset = (size_t)((uint8_t *)p_blk - p_pool->buf_ptr);
+
+    if ((uint8_t *)p_blk < p_pool->buf_ptr ||
+        offset >= p_pool->blk_size * p_pool->blk_num ||
+        (offset % p_pool->blk_size) != 0u)
+    {
+        // OSUniversalError = OS_ERR_POOL_INVALID_BLOCK;
+        os_assert(0, "OS_ERR_POOL_INVALID_BLOCK");
+        return OS_FALSE;
+    }
+    return OS_TRUE;
+}
+
+void os_pool_put(pool_t *p_pool, void *p_blk)
+{
+    if (pool_blk_is_valid(p_pool, p_blk) == OS_FALSE)
+    {
+        return;
+    }
+
+    ENTER_CRITICAL();
+    pool_blk_next(p_blk) = p_pool->free_list_ptr;
+    p_pool->free_list_ptr = p_blk;
+    p_pool->used--;
+    EXIT_CRITICAL();
+}
+
+void os_pool_put_chain(pool_t *p_pool, void *p_first, uint16_t num)
+{
+    void *p_last = p_first;
+    uint16_t index;
+
+    if (num == 0u)
+    {
+        return;
+    }
+    /* Chain is owned by caller, it is checked out of critical section */
+    for (index = 0; index < num; index++)
+    {
+        if (p_last == NULL || pool_blk_is_valid(p_pool, p_last) == OS_FALSE)
+        {
+            return;
+        }
+        if (index < (num - 1u))
+        {
+            p_last = pool_blk_next(p_last);
+        }
+    }
+
+    ENTER_CRITICAL();
+    pool_blk_next(p_last) = p_pool->free_list_ptr;
+    p_pool->free_list_ptr = p_first;
+    p_pool->used -= num;
+    EXIT_CRITICAL();
+}
+
+void os_pool_get_stats(pool_t *p_pool, pool_stats_t *p_stats)
+{
+    ENTER_CRITICAL();
+    p_stats->blk_size = p_pool->blk_size;
+    p_stats->blk_num = p_pool->blk_num;
+    p_stats->used = p_pool->used;
+    p_stats->used_max = p_pool->used_max;
+    p_stats->get_fail = p_pool->get_fail;
+    EXIT_CRITICAL();
+}
@@ -1,6 +1,27 @@
 #include "os_prio.h"
+
+/* Count leading zeros, one instruction (CLZ) on Cortex-M3 */
+#if (defined(__GNUC__) || defined(__clang__)) && (OS_CFG_PRIO_SOFT_CLZ == 0u)
+#define prio_clz(x)         ((uint32_t)__builtin_clz(x))
+#else
+static uint32_t prio_clz(uint32_t x)
+{
+    uint32_t n = 0u;
+    if ((x & 0xFFFF0000u) == 0u) { n += 16u; x <<= 16u; }
+    if ((x & 0xFF000000u) == 0u) { n += 8u;  x <<= 8u;  }
+    if ((x & 0xF0000000u) == 0u) { n += 4u;  x <<= 4u;  }
+    if ((x & 0xC0000000u) == 0u) { n += 2u;  x <<= 2u;  }
+    if ((x & 0x80000000u) == 0u) { n += 1u; }
+    return n;
+}
+#endif
+
+/* Bit (31 - n) of a word stands for n, so CLZ of a word is the highest prio in it */
+#define prio_bit(n)         ((uint32_t)0x80000000u >> (n))
+
 static uint32_t prio_curr;
-static uint8_t prio_tbl[OS_PRIO_TBL_SIZE];
+static uint32_t prio_grp;                       /* Bit of row is set when row of table is not empty */
+static uint32_t prio_tbl[OS_PRIO_TBL_SIZE];
 
 void os_prio_init()
 {
@@ -9,53 +30,46 @@ void os_prio_init()
     {
         prio_tbl[i] = 0u;
     }
+    prio_grp = 0u;
     /* OS_CFG_PRIO_MAX-1 is the lowest priority level and that is idle task's prio     */
     os_prio_insert(OS_CFG_PRIO_MAX - 1);
 }
 
 void os_prio_insert(uint32_t prio)
 {
-    uint8_t bit;
-    uint8_t row;
+    uint32_t bit;
+    uint32_t row;
 
-    row = (uint32_t)(prio / (8u));
-    bit = (uint8_t)prio & ((8u) - 1u);
-    prio_tbl[row] |= (uint8_t)1u << (((8u) - 1u) - bit);
+    row = prio / OS_PRIO_BITS_PER_ROW;
+    bit = prio & (OS_PRIO_BITS_PER_ROW - 1u);
+    prio_tbl[row] |= prio_bit(bit);
+    prio_grp |= prio_bit(row);
 }
 
 void os_prio_remove(uint32_t prio)
 {
-    uint8_t bit;
-    uint8_t row;
+    uint32_t bit;
+    uint32_t row;
 
-    row = (uint32_t)(prio / (8u));
-    bit = (uint8_t)prio & ((8u) - 1u);
-    prio_tbl[row] &= ~((uint8_t)1u << (((8u) - 1u) - bit));
+    row = prio / OS_PRIO_BITS_PER_ROW;
+    bit = prio & (OS_PRIO_BITS_PER_ROW - 1u);
+    prio_tbl[row] &= ~prio_bit(bit);
+    if (prio_tbl[row] == 0u)
+    {
+        prio_grp &= ~prio_bit(row);
+    }
 }
 
 uint32_t os_prio_get_highest(void)
 {
-    uint8_t *p_tbl;
-    uint32_t prio;
-
-    prio = 0u;
-    p_tbl = &prio_tbl[0];
-    while (*p_tbl == 0u)
-    {                 /* Search the bitmap table for the highest priority     */
-        prio += (8u); /* Compute the step of each CPU_DATA entry              */
-        p_tbl++;
-    }
+    uint32_t row;
 
-    uint8_t bit = (uint8_t)prio & ((8u) - 1u);
-    while (!(*p_tbl & ((uint8_t)1u << (((8u) - 1u) - bit))))
-    {
-        prio++;
-        bit = (uint8_t)prio & ((8u) - 1u);
-    }
-    return (prio);
+    /* Idle prio is always inserted, so the group is never empty */
+    row = prio_clz(prio_grp);
+    return (row * OS_PRIO_BITS_PER_ROW) + prio_clz(prio_tbl[row]);
 }
 
 uint32_t os_prio_get_curr(void)
 {
     return prio_curr;
-}
\ No newline at end of file
+}
@@ -5,16 +5,10 @@
 #include "os_timer.h"
 #include "os_prio.h"
 #include "os_cpu.h"
+#include "os_wheel.h"
 #include <string.h>
 #include "task_list.h"
 
-/* For strict compliance with the Cortex-M spec the task start address should
-have bit-0 clear, as it is loaded into the PC on exit from an ISR. */
-#define VALUE_START_ADDRESS_MASK    ((uint32_t)0xfffffffeUL)
-
-/* Constants required to set up the initial stack. */
-#define VALUE_INITIAL_XPSR          (0x01000000)
-
 #define TASK_IDLE_ID                ((task_id_t)TASK_EOT_ID)
 
 #define TASK_IDLE_PRI               (OS_CFG_PRIO_MAX - 1u)
@@ -25,6 +19,12 @@ have bit-0 clear, as it is loaded into the PC on exit from an ISR. */
 
 #define TASK_TIMER_STK_SIZE         (100u) 
 
+#if (OS_CFG_USE_TIMER_TASK == 1u)
+#define TASK_IDLE_STK_SIZE          (OS_CFG_TASK_STK_SIZE_MIN)
+#else
+#define TASK_IDLE_STK_SIZE          (OS_CFG_TASK_STK_SIZE_MIN + OS_CFG_TIMER_CB_STK_SIZE) /* Timer callbacks run on idle task */
+#endif
+
 
 typedef struct task_tcb task_tcb_t;
 
@@ -38,31 +38,92 @@ task_tcb_t *volatile tcb_curr_ptr = NULL;
 task_tcb_t *volatile tcb_high_rdy_ptr = NULL;
 
 static list_t rdy_task_list[OS_CFG_PRIO_MAX];       /*< Prioritised ready tasks. */
+#if (OS_CFG_USE_DLY_WHEEL == 1u)
+static wheel_t dly_task_wheel;                      /*< Delayed tasks, tick overflow is handled by the wheel itself. */
+#endif
 static list_t dly_task_list_1;                      /*< Delayed tasks. */
 static list_t dly_task_list_2;                      /*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
 static list_t *volatile dly_task_list_ptr;          /*< Points to the delayed task list currently being used. */
 static list_t *volatile overflow_dly_task_list_ptr; /*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 static list_t suspended_task_list;                  /*< Tasks that are currently suspended. */
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+static list_t msg_pool_wait_list;                   /*< Senders blocked as msg pool is empty, by prio. */
+#endif
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+static list_t sig_wait_list;                        /*< Receivers blocked with a signal pending as msg pool is empty, by prio. */
+#endif
 
 static volatile uint16_t num_of_tasks           = (uint16_t)0U;
-static volatile uint32_t tick_count             = (uint32_t)0u;
+static volatile uint32_t tick_count             = (uint32_t)OS_CFG_TICK_COUNT_INIT;
 static volatile uint32_t ticks_pended           = (uint32_t)0U;
 static volatile uint32_t next_tick_to_unblock   = (uint32_t)OS_CFG_DELAY_MAX; /* Initialised to portMAX_DELAY before the scheduler starts. */
 
 static volatile uint8_t sched_is_running        = (uint8_t)OS_FALSE;
 
+#if (OS_CFG_USE_MSG_PUBSUB == 1u)
+typedef struct
+{
+    int32_t sig_first;
+    int32_t sig_last;
+    uint32_t task_mask; /* Bit n set: task n subscribed to this range */
+} task_sub_t;
+
+static task_sub_t task_sub_tbl[OS_CFG_MSG_SUB_MAX];
+static uint8_t task_sub_num;
+#endif
+
+#if (OS_CFG_USE_MSG_PUBSUB == 1u) || (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+/* Count trailing zeros, lowest set bit in a mask */
+#if defined(__GNUC__) || defined(__clang__)
+#define task_ctz(x)         ((uint32_t)__builtin_ctz(x))
+#else
+static uint32_t task_ctz(uint32_t x)
+{
+    uint32_t n = 0u;
+    while ((x & 1u) == 0u)
+    {
+        x >>= 1u;
+        n++;
+    }
+    return n;
+}
+#endif
+#endif
+
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+static uint32_t tick_suppressed_count           = (uint32_t)0U;      /* Tick interrupts avoided by tickless idle */
+#endif
+
 uint32_t os_task_get_tick(void)
 {
     return tick_count;
 }
 
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+static uint32_t task_get_expected_idle_ticks(void);
+#endif
+
 static void task_idle_func(void *p_arg)
 {
     for (;;)
     {
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+        os_timer_run_deferred();
+#endif
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+        ENTER_CRITICAL();
+        uint32_t expected_idle_ticks = task_get_expected_idle_ticks();
+        if (expected_idle_ticks >= OS_CFG_TICKLESS_IDLE_MIN)
+        {
+            /* Port stops tick, sleeps and catches tick count up by os_task_step_tick() */
+            os_cpu_suppress_ticks_and_sleep(expected_idle_ticks);
+        }
+        EXIT_CRITICAL();
+#endif
     }
 }
 
+#if (OS_CFG_USE_TIMER_TASK == 1u)
 static void task_timer_func(void *p_arg)
 {
     for (;;)
@@ -70,6 +131,7 @@ static void task_timer_func(void *p_arg)
         os_timer_processing();
     }
 }
+#endif
 
 struct task_tcb
 {
@@ -82,25 +144,59 @@ struct task_tcb
     uint32_t *stk_base_ptr;     /* Pointer to base address of stack 					    */
     task_id_t id;
     msg_queue_t msg_queue;
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+    msg_queue_t urgent_queue;   /* Urgent lane, drained before msg_queue */
+#endif
     task_state_t state;         /* States */
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+    list_t send_wait_list;      /* Senders blocked as msg_queue is full, by prio */
+#endif
+#if (OS_CFG_USE_MSG_WAIT_SIG == 1u)
+    msg_match_t pf_match;       /* Set while task waits for a msg it selects, it is woken only by a match */
+    void *match_arg;
+#endif
+#if (OS_CFG_USE_TASK_HANDOFF == 1u)
+    uint8_t handoff;            /* Posts that wake this task give it the CPU at once (equal prio) */
+#endif
+#if (OS_CFG_USE_MSG_RPC == 1u)
+    uint8_t *rsp_ptr;           /* Reply slot: caller buffer, server copies reply into it */
+    uint16_t rsp_size;          /* Size of buffer, then size of reply */
+    uint8_t call_seq;           /* Call being waited for, late replies to older calls are ignored */
+    uint8_t call_state;
+#endif
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    int32_t sig_coal_first;     /* Pure signals sig_coal_first.. +sig_coal_num-1 are not queued */
+    uint8_t sig_coal_num;
+    uint32_t sig_pending;       /* Bit n: sig_coal_first + n is pending */
+#endif
 };
 
 static void init_task_lists(void)
 {
     /* Initialize lists */
-    uint8_t prio;
+    uint16_t prio;
     for (prio = 0; prio < OS_CFG_PRIO_MAX; prio++)
     {
         os_list_init(&(rdy_task_list[prio]));
     }
     os_list_init(&dly_task_list_1);
     os_list_init(&dly_task_list_2);
+#if (OS_CFG_USE_DLY_WHEEL == 1u)
+    os_wheel_init(&dly_task_wheel, tick_count);
+#endif
     os_list_init(&suspended_task_list);
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+    os_list_init(&msg_pool_wait_list);
+#endif
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    os_list_init(&sig_wait_list);
+#endif
     dly_task_list_ptr = &dly_task_list_1;
     overflow_dly_task_list_ptr = &dly_task_list_2;
     /********************/
 }
 
+#if (OS_CFG_USE_DLY_WHEEL == 0u)
 static void task_switch_delay_lists()
 {
     list_t *p_list_temp;
@@ -127,6 +223,7 @@ static void task_switch_delay_lists()
         next_tick_to_unblock = item_value;
     }
 }
+#endif
 
 static void add_new_task_to_rdy_list(task_tcb_t *p_tcb)
 {
@@ -189,6 +286,10 @@ static void add_curr_task_to_delay_list(uint32_t tick_to_delay, uint8_t can_bloc
         time_to_wake = const_tick + tick_to_delay;
         list_item_set_value(&(tcb_curr_ptr->state_list_item), time_to_wake);
 
+#if (OS_CFG_USE_DLY_WHEEL == 1u)
+        /* O(1), the wheel handles overflow of wake time */
+        os_wheel_insert(&dly_task_wheel, &(tcb_curr_ptr->state_list_item));
+#else
         if (time_to_wake < const_tick)
         {
             /* Wake time has overflowed.  Place this item in the overflow
@@ -210,6 +311,7 @@ static void add_curr_task_to_delay_list(uint32_t tick_to_delay, uint8_t can_bloc
                 next_tick_to_unblock = time_to_wake;
             }
         }
+#endif
         /*Save state*/
         tcb_curr_ptr->state = TASK_STATE_DELAYED;
     }
@@ -225,7 +327,8 @@ static task_tcb_t *os_task_create(task_id_t id,
                                   void *p_arg,
                                   uint8_t prio,
                                   size_t queue_size,
-                                  size_t stack_size)
+                                  size_t stack_size,
+                                  msg_q_policy_t queue_policy)
 {
     if (sched_is_running == OS_TRUE)
     {
@@ -283,21 +386,12 @@ static task_tcb_t *os_task_create(task_id_t id,
     }
 
     /*Now TCB and stack are created*/
-    uint32_t *p_stack_ptr;
 
     /* Fill the stack with a known value to assist debugging. */
     //( void ) memset( p_new_tcb->stk_limit_ptr, OS_CFG_TASK_STACK_FILL_BYTE, stack_size );
 
-    /*Init stack frame*/
-    p_stack_ptr = &p_stack[stack_size - (uint32_t)1];
-    p_stack_ptr = (uint32_t *)(((uint32_t)p_stack_ptr) & (~((uint32_t)0x007))); /* Allign byte */
-    // p_stack_ptr             =   ( p_stack + ( uint32_t )( ( uint32_t )( stack_size / 4 ) - (uint32_t) 1 ) );
-    *(--p_stack_ptr) = VALUE_INITIAL_XPSR;                             /*Add offset and assign value for xPSR */
-    *(--p_stack_ptr) = ((uint32_t)pf_task) & VALUE_START_ADDRESS_MASK; /* PC */
-    *(--p_stack_ptr) = (uint32_t)0x000000EU;                           /* LR */
-    p_stack_ptr -= 5;                                                  /* R12, R3, R2 and R1. */
-    *p_stack_ptr = (uint32_t)p_arg;                                    /* R0 */
-    p_stack_ptr -= 8;                                                  /* R11, R10, R9, R8, R7, R6, R5 and R4. */
+    /*Init stack frame, it is port specific*/
+    uint32_t *p_stack_ptr = os_cpu_task_stack_init(p_stack, stack_size, pf_task, p_arg);
 
     /*Save top of stack (Stack pointer)*/
     p_new_tcb->stk_ptr = p_stack_ptr;
@@ -312,7 +406,12 @@ static task_tcb_t *os_task_create(task_id_t id,
     p_new_tcb->prio = prio;
     // os_prio_insert(prio);
 
-    os_msg_queue_init(&(p_new_tcb->msg_queue), queue_size);
+    os_msg_queue_init(&(p_new_tcb->msg_queue), queue_size, queue_policy);
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+    /* Urgent msgs are never dropped or overwritten quietly, a full lane rejects the post.
+    A task without msg queue (idle) gets no lane either, a post to it is rejected */
+    os_msg_queue_init(&(p_new_tcb->urgent_queue), (queue_size != 0u) ? OS_CFG_MSG_URGENT_Q_SIZE : 0u, MSG_Q_OVERFLOW_ASSERT);
+#endif
 
     /* Init linked lists */
     os_list_item_init(&(p_new_tcb->state_list_item));
@@ -322,12 +421,26 @@ static task_tcb_t *os_task_create(task_id_t id,
     list_item_set_owner(&(p_new_tcb->event_list_item), (void *)p_new_tcb);
 
     list_item_set_value(&(p_new_tcb->state_list_item), prio);
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+    os_list_init(&(p_new_tcb->send_wait_list));
+#endif
 
     add_new_task_to_rdy_list(p_new_tcb);
 
     return p_new_tcb;
 }
 
+/* A task that could not be created would be posted to later through a NULL TCB, stop here instead */
+static void task_check_created(task_tcb_t *p_tcb)
+{
+    if (p_tcb == NULL)
+    {
+        LOG_ERROR("OS_ERR_TASK_NOT_CREATED - Check OS_CFG_HEAP_SIZE, entering while loop");
+        DISABLE_INTERRUPTS
+        while(1);
+    }
+}
+
 void os_task_create_list(task_t *task_tbl, uint8_t size)
 {
     uint8_t idx = 0;
@@ -339,34 +452,80 @@ void os_task_create_list(task_t *task_tbl, uint8_t size)
                                (void *)task_tbl[idx].p_arg,
                                (uint8_t)task_tbl[idx].prio,
                                (size_t)task_tbl[idx].queue_size,
-                               (size_t)task_tbl[idx].stack_size);
+                               (size_t)task_tbl[idx].stack_size,
+                               task_tbl[idx].queue_policy);
+        task_check_created(p_tcb);
         task_tcb_list[task_tbl[idx].id] = p_tcb;
         idx++;
     }
+#if (OS_CFG_USE_TIMER_TASK == 1u)
     p_tcb = os_task_create((task_id_t)TASK_TIMER_ID,
                            (task_func_t)task_timer_func,
                            (void *)NULL,
                            (uint8_t)TASK_TIMER_PRI,
                            (size_t)(OS_CFG_TASK_MSG_Q_SIZE_NORMAL),
-                           (size_t)TASK_TIMER_STK_SIZE);
+                           (size_t)TASK_TIMER_STK_SIZE,
+                           MSG_Q_OVERFLOW_ASSERT);
+    task_check_created(p_tcb);
     task_tcb_list[TASK_TIMER_ID] = p_tcb;
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    /* Dummy wakeups of timer task only need to be pending once */
+    p_tcb->sig_coal_first = 0;
+    p_tcb->sig_coal_num = 1u;
+#endif
+#endif
 
     p_tcb = os_task_create((task_id_t)TASK_IDLE_ID,
                            (task_func_t)task_idle_func,
                            (void *)NULL,
                            (uint8_t)TASK_IDLE_PRI,
                            (size_t)(0u),
-                           (size_t)OS_CFG_TASK_STK_SIZE_MIN);
+                           (size_t)TASK_IDLE_STK_SIZE,
+                           MSG_Q_OVERFLOW_ASSERT);
+    task_check_created(p_tcb);
     task_tcb_list[TASK_IDLE_ID] = p_tcb;
 }
 
-uint8_t os_task_increment_tick(void)
+static uint8_t task_wake_delayed(task_tcb_t *p_tcb)
+{
+    os_list_remove(&(p_tcb->state_list_item)); /*Remove from block state*/
+
+    /* Is the task waiting on an event also?  If so remove
+     * it from the event list. */
+    if (list_item_get_list_contain(&(p_tcb->event_list_item)) != NULL)
+    {
+        os_list_remove(&(p_tcb->event_list_item));
+    }
+    add_task_to_rdy_list(p_tcb);
+    if (p_tcb->prio < tcb_curr_ptr->prio)
+    {
+        tcb_high_rdy_ptr = p_tcb;
+        return OS_TRUE;
+    }
+    return OS_FALSE;
+}
+
+/* Move tick count to const_tick and wake every delayed task expired till then */
+static uint8_t task_advance_tick(const uint32_t const_tick)
 {
     uint8_t is_switch_needed = OS_FALSE;
     task_tcb_t *p_tcb;
-    uint32_t item_value;
 
-    const uint32_t const_tick = tick_count + (uint32_t)1;
+#if (OS_CFG_USE_DLY_WHEEL == 1u)
+    list_t *p_due_list;
+
+    /* Wheel moves one tick at a time, const_tick is always tick_count + 1 */
+    tick_count = const_tick;
+
+    /* Every task in due slot wakes on this tick */
+    p_due_list = os_wheel_tick(&dly_task_wheel);
+    while (list_is_empty(p_due_list) == OS_FALSE)
+    {
+        p_tcb = list_get_owner_of_head_item(p_due_list);
+        is_switch_needed |= task_wake_delayed(p_tcb);
+    }
+#else
+    uint32_t item_value;
 
     /* Increment the RTOS tick, switching the delayed and overflowed
      * delayed lists if it wraps to 0. */
@@ -396,23 +555,33 @@ uint8_t os_task_increment_tick(void)
                     next_tick_to_unblock = item_value;
                     break;
                 }
-                os_list_remove(&(p_tcb->state_list_item)); /*Remove from block state*/
-
-                /* Is the task waiting on an event also?  If so remove
-                 * it from the event list. */
-                if (list_item_get_list_contain(&(p_tcb->event_list_item)) != NULL)
-                {
-                    os_list_remove(&(p_tcb->event_list_item));
-                }
-                add_task_to_rdy_list(p_tcb);
-                if (p_tcb->prio < tcb_curr_ptr->prio)
-                {
-                    tcb_high_rdy_ptr = p_tcb;
-                    is_switch_needed = OS_TRUE;
-                }
+                is_switch_needed |= task_wake_delayed(p_tcb);
             }
         }
     }
+#endif
+    return is_switch_needed;
+}
+
+uint8_t os_task_increment_tick(void)
+{
+    uint8_t is_switch_needed = task_advance_tick(tick_count + (uint32_t)1);
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_timer_hard_processing();
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+    /* Timers expire here */
+    os_timer_tick_processing();
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 0u) || (OS_CFG_USE_TIMER_HARD == 1u)
+    /* Signals posted by timers may wake tasks as well */
+    if (tcb_high_rdy_ptr != tcb_curr_ptr)
+    {
+        tcb_high_rdy_ptr = list_get_owner_of_head_item(&(rdy_task_list[os_prio_get_highest()]));
+        is_switch_needed = OS_TRUE;
+    }
+#endif
 
     uint8_t highest_prio = os_prio_get_highest();
     if (list_get_num_item(&(rdy_task_list[highest_prio])) > 1u)
@@ -426,8 +595,121 @@ uint8_t os_task_increment_tick(void)
     return is_switch_needed;
 }
 
+#if (OS_CFG_USE_TICKLESS_IDLE == 1u)
+static uint32_t task_get_expected_idle_ticks(void)
+{
+    uint32_t expected_idle_ticks;
+    uint32_t next_tick_timer;
+    uint8_t is_timer_armed = os_timer_get_next_tick(&next_tick_timer);
+    const uint32_t ticks_to_timer = next_tick_timer - tick_count;
+
+    if (list_get_num_item(&(rdy_task_list[TASK_IDLE_PRI])) > 1u)
+    {
+        /* Another task shares idle prio, tick is needed for round-robin */
+        return 0u;
+    }
+#if (OS_CFG_USE_DLY_WHEEL == 1u)
+    expected_idle_ticks = os_wheel_get_next_delta(&dly_task_wheel);
+#else
+    /* Delayed tasks are woken on the tick they are due, so next_tick_to_unblock is never behind tick_count
+    and its distance holds across tick overflow. OS_CFG_DELAY_MAX (none delayed) gives ticks till overflow */
+    expected_idle_ticks = next_tick_to_unblock - tick_count;
+#endif
+    /* Timer tick may be past tick overflow, it is only behind tick_count (over half range away) if timer task is late */
+    if ((is_timer_armed == OS_TRUE) && ((ticks_to_timer == 0u) || (ticks_to_timer > (OS_CFG_DELAY_MAX >> 1))))
+    {
+        /* Timer is due */
+        return 0u;
+    }
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    if (os_timer_hard_get_next_delta() < expected_idle_ticks)
+    {
+        expected_idle_ticks = os_timer_hard_get_next_delta();
+    }
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+    if (os_timer_has_deferred() == OS_TRUE)
+    {
+        /* Timer callbacks are waiting for idle task */
+        return 0u;
+    }
+#endif
+    if ((is_timer_armed == OS_TRUE) && (ticks_to_timer < expected_idle_ticks))
+    {
+        expected_idle_ticks = ticks_to_timer;
+    }
+    return expected_idle_ticks;
+}
+
+uint8_t os_task_step_tick(uint32_t ticks_to_step)
+{
+    uint8_t is_switch_needed = OS_FALSE;
+    uint8_t highest_prio;
+
+    tick_suppressed_count += ticks_to_step;
+
+#if (OS_CFG_USE_DLY_WHEEL == 1u)
+    while (ticks_to_step > 0u)
+    {
+        /* Jump over ticks that wheel has nothing to do, keep one to land on */
+        ticks_to_step -= os_wheel_skip(&dly_task_wheel, ticks_to_step - 1u);
+        tick_count = dly_task_wheel.time;
+        is_switch_needed |= task_advance_tick(tick_count + (uint32_t)1);
+        ticks_to_step--;
+    }
+#else
+    const uint32_t const_tick = tick_count + ticks_to_step;
+
+    if (const_tick < tick_count)
+    {
+        /* Tick wraps, every task left in current list expires before lists are switched */
+        if (tick_count != OS_CFG_DELAY_MAX)
+        {
+            is_switch_needed |= task_advance_tick(OS_CFG_DELAY_MAX);
+        }
+        is_switch_needed |= task_advance_tick((uint32_t)0U);
+    }
+    if (const_tick != tick_count)
+    {
+        is_switch_needed |= task_advance_tick(const_tick);
+    }
+#endif
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_timer_hard_processing();
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+    /* Timer lists follow tick (handle overflow), nothing is expected to expire on the way */
+    os_timer_tick_processing();
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 0u) || (OS_CFG_USE_TIMER_HARD == 1u)
+    if (tcb_high_rdy_ptr != tcb_curr_ptr)
+    {
+        is_switch_needed = OS_TRUE;
+    }
+#endif
+
+    if (is_switch_needed == OS_TRUE)
+    {
+        /* Several tasks may wake at once, pick the highest of them */
+        highest_prio = os_prio_get_highest();
+        tcb_high_rdy_ptr = list_get_owner_of_head_item(&(rdy_task_list[highest_prio]));
+        tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
+    }
+    return is_switch_needed;
+}
+
+uint32_t os_task_get_tick_suppressed(void)
+{
+    return tick_suppressed_count;
+}
+#endif
+
 void os_task_delay(const uint32_t tick_to_delay)
 {
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_assert(os_timer_in_hard_cb() == OS_FALSE, "OS_ERR_BLOCKING_IN_HARD_TIMER");
+#endif
     if (tick_to_delay > (uint32_t)0U)
     {
         ENTER_CRITICAL();
@@ -437,181 +719,951 @@ void os_task_delay(const uint32_t tick_to_delay)
     }
 }
 
+uint32_t os_task_delay_until(uint32_t *p_last_wake, const uint32_t period)
+{
+    uint32_t overrun = (uint32_t)0U;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_assert(os_timer_in_hard_cb() == OS_FALSE, "OS_ERR_BLOCKING_IN_HARD_TIMER");
+#endif
+    ENTER_CRITICAL();
+    {
+        /* Unsigned difference stays right when tick count wraps */
+        const uint32_t elapsed = tick_count - *p_last_wake;
+
+        /* Next deadline is always one period after the previous one, never after now */
+        *p_last_wake += period;
+
+        if (elapsed < period)
+        {
+            add_curr_task_to_delay_list(period - elapsed, OS_FALSE);
+            os_cpu_trigger_PendSV();
+        }
+        else
+        {
+            /* Deadline has already passed, do not block */
+            overrun = elapsed - period;
+        }
+    }
+    EXIT_CRITICAL();
+    return overrun;
+}
+
 void os_task_start(void)
 {
     tcb_high_rdy_ptr = list_get_owner_of_head_item(&(rdy_task_list[os_prio_get_highest()]));
     tcb_curr_ptr = tcb_high_rdy_ptr;
-    tick_count = 0u;
+    tick_count = OS_CFG_TICK_COUNT_INIT;
     next_tick_to_unblock = OS_CFG_DELAY_MAX;
     sched_is_running = OS_TRUE;
 }
 
-void os_task_post_msg_dynamic(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size)
+/* Called in critical section, readies a blocked task */
+static void task_unblock(task_tcb_t *p_tcb)
 {
-    ENTER_CRITICAL();
-    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    /* Remove it from suspended or delayed list */
+    if (list_item_get_list_contain(&(p_tcb->state_list_item)) != NULL)
     {
-        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
-        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
-        EXIT_CRITICAL();
-        return;
+        os_list_remove(&(p_tcb->state_list_item));
     }
 
-    switch (task_tcb_list[des_task_id]->state)
+    /* Is the task waiting on an event also?  If so remove
+     * it from the event list. */
+    if (list_item_get_list_contain(&(p_tcb->event_list_item)) != NULL)
     {
-    case TASK_STATE_SUSPENDED_ON_MSG:
-        os_msg_queue_put_dynamic(&(task_tcb_list[des_task_id]->msg_queue),
-                                 sig,
-                                 p_content,
-                                 msg_size);
+        os_list_remove(&(p_tcb->event_list_item));
+    }
 
-        /* Is the task waiting on an event ?  If so remove
-         * it from the event list. */
-        if (list_item_get_list_contain(&(task_tcb_list[des_task_id]->event_list_item)) != NULL)
-        {
-            os_list_remove(&(task_tcb_list[des_task_id]->event_list_item));
-        }
-        add_task_to_rdy_list(task_tcb_list[des_task_id]);
-        if (task_tcb_list[des_task_id]->prio < tcb_curr_ptr->prio)
-        {
-            tcb_high_rdy_ptr = task_tcb_list[des_task_id];
+    add_task_to_rdy_list(p_tcb);
+    if (p_tcb->prio < tcb_curr_ptr->prio)
+    {
+        tcb_high_rdy_ptr = p_tcb;
 
-            /*Save state*/
-            tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
+        /*Save state*/
+        tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
 
-            os_cpu_trigger_PendSV();
-        }
-        EXIT_CRITICAL();
-        break;
-    case TASK_STATE_DELAYED_ON_MSG:
-        os_msg_queue_put_dynamic(&(task_tcb_list[des_task_id]->msg_queue),
-                                 sig,
-                                 p_content,
-                                 msg_size);
-        /* Is the task waiting on an event ?  If so remove
-         * it from the event list. */
-        if (list_item_get_list_contain(&(task_tcb_list[des_task_id]->state_list_item)) != NULL)
-        {
-            os_list_remove(&(task_tcb_list[des_task_id]->state_list_item));
-        }
+        os_cpu_trigger_PendSV();
+    }
+}
 
-        add_task_to_rdy_list(task_tcb_list[des_task_id]);
-        if (task_tcb_list[des_task_id]->prio < tcb_curr_ptr->prio)
-        {
-            tcb_high_rdy_ptr = task_tcb_list[des_task_id];
+/* Called in critical section after a msg was put to queue of p_tcb, readies it if it waits for msg */
+#if (OS_CFG_USE_MSG_WAIT_SIG == 1u)
+static uint8_t task_has_match(task_tcb_t *p_tcb);
+#endif
 
-            /*Save state*/
-            tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
+#if (OS_CFG_USE_TASK_HANDOFF == 1u)
+/* Called in critical section. Ready p_tcb of same prio runs now instead of at next round-robin tick */
+static void task_handoff(task_tcb_t *p_tcb)
+{
+    if (p_tcb == tcb_curr_ptr || p_tcb->state != TASK_STATE_READY ||
+        p_tcb->prio != tcb_curr_ptr->prio || p_tcb->prio > tcb_high_rdy_ptr->prio)
+    {
+        return; /* Never before a higher prio task that is already switched to */
+    }
+    tcb_high_rdy_ptr = p_tcb;
 
-            os_cpu_trigger_PendSV();
-        }
-        EXIT_CRITICAL();
-        break;
+    /*Save state*/
+    tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
 
-    default:
-        os_msg_queue_put_dynamic(&(task_tcb_list[des_task_id]->msg_queue),
-                                 sig,
-                                 p_content,
-                                 msg_size);
-        EXIT_CRITICAL();
-        break;
-    }
+    os_cpu_trigger_PendSV();
 }
+#endif
 
-void os_task_post_msg_pure(uint8_t des_task_id, int32_t sig)
+static void task_wake_on_msg(task_tcb_t *p_tcb)
 {
-    ENTER_CRITICAL();
-#if 0 /* Under testing */
-    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    if (p_tcb->state != TASK_STATE_SUSPENDED_ON_MSG && p_tcb->state != TASK_STATE_DELAYED_ON_MSG)
     {
-        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
-        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
-        EXIT_CRITICAL();
-        return;
+        return; /*DELAYED, SUSPEND, RUNNING*/
+    }
+#if (OS_CFG_USE_MSG_WAIT_SIG == 1u)
+    if (p_tcb->pf_match != NULL && task_has_match(p_tcb) == OS_FALSE)
+    {
+        return; /* Not the msg it waits for */
     }
 #endif
-    switch (task_tcb_list[des_task_id]->state)
+    task_unblock(p_tcb);
+#if (OS_CFG_USE_TASK_HANDOFF == 1u)
+    if (p_tcb->handoff == OS_TRUE)
     {
-    case TASK_STATE_SUSPENDED_ON_MSG:
-        os_msg_queue_put_pure(&(task_tcb_list[des_task_id]->msg_queue), sig);
-        /* Is the task waiting on an event ?  If so remove
-         * it from the event list. */
-        if (list_item_get_list_contain(&(task_tcb_list[des_task_id]->event_list_item)) != NULL)
-        {
-            os_list_remove(&(task_tcb_list[des_task_id]->event_list_item));
-        }
-        add_task_to_rdy_list(task_tcb_list[des_task_id]);
-        if (task_tcb_list[des_task_id]->prio < tcb_curr_ptr->prio)
-        {
-            tcb_high_rdy_ptr = task_tcb_list[des_task_id];
-
-            /*Save state*/
-            tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
-
-            os_cpu_trigger_PendSV();
-        }
-        EXIT_CRITICAL();
-        break;
-    case TASK_STATE_DELAYED_ON_MSG:
-        os_msg_queue_put_pure(&(task_tcb_list[des_task_id]->msg_queue), sig);
-        /* Is the task waiting on an event ?  If so remove
-         * it from the event list. */
-        if (list_item_get_list_contain(&(task_tcb_list[des_task_id]->state_list_item)) != NULL)
-        {
-            os_list_remove(&(task_tcb_list[des_task_id]->state_list_item));
-        }
-
-        /* Is the task waiting on an event also?  If so remove
-         * it from the event list. */
-        if (list_item_get_list_contain(&(task_tcb_list[des_task_id]->event_list_item)) != NULL)
-        {
-            os_list_remove(&(task_tcb_list[des_task_id]->event_list_item));
-        }
+        task_handoff(p_tcb);
+    }
+#endif
+}
 
-        add_task_to_rdy_list(task_tcb_list[des_task_id]);
-        if (task_tcb_list[des_task_id]->prio < tcb_curr_ptr->prio)
-        {
-            tcb_high_rdy_ptr = task_tcb_list[des_task_id];
+#if (OS_CFG_USE_TASK_HANDOFF == 1u)
+void os_task_set_handoff(uint8_t task_id, uint8_t is_enabled)
+{
+    ENTER_CRITICAL();
+    task_tcb_list[task_id]->handoff = is_enabled;
+    EXIT_CRITICAL();
+}
 
-            /*Save state*/
-            tcb_high_rdy_ptr->state = TASK_STATE_RUNNING;
+void os_task_handoff(uint8_t task_id)
+{
+    ENTER_CRITICAL();
+    task_handoff(task_tcb_list[task_id]);
+    EXIT_CRITICAL();
+}
+#endif
 
-            os_cpu_trigger_PendSV();
-        }
-        EXIT_CRITICAL();
-        break;
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+/* Called in critical section. Returns OS_TRUE if sig is in coalesced range of p_tcb, it is only marked pending */
+static uint8_t task_sig_coalesce(task_tcb_t *p_tcb, int32_t sig)
+{
+    uint32_t idx = (uint32_t)sig - (uint32_t)p_tcb->sig_coal_first;
+    if (idx < p_tcb->sig_coal_num)
+    {
+        p_tcb->sig_pending |= (uint32_t)1u << idx;
+        return OS_TRUE;
+    }
+    return OS_FALSE;
+}
 
-    default: /*DELAYED, SUSPEND, RUNNING*/
-        os_msg_queue_put_pure(&(task_tcb_list[des_task_id]->msg_queue), sig);
-        EXIT_CRITICAL();
-        break;
+void os_task_coalesce_sig(uint8_t task_id, int32_t sig_first, uint8_t num)
+{
+    if (num > 32u)
+    {
+        // OSUniversalError = OS_ERR_TASK_SIG_COALESCE_INVALID;
+        os_assert(0, "OS_ERR_TASK_SIG_COALESCE_INVALID");
+        return;
     }
+    ENTER_CRITICAL();
+    task_tcb_list[task_id]->sig_coal_first = sig_first;
+    task_tcb_list[task_id]->sig_coal_num = num;
+    task_tcb_list[task_id]->sig_pending = 0u;
+    EXIT_CRITICAL();
 }
+#endif
 
-msg_t *os_task_wait_for_msg(uint32_t time_out)
+/* Called in critical section */
+static void task_put_pure(task_tcb_t *p_tcb, int32_t sig)
 {
-    msg_t *p_msg = os_msg_queue_get(&(task_tcb_list[tcb_curr_ptr->id]->msg_queue));
-    if (time_out > (uint32_t)0U && p_msg == NULL)
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    if (task_sig_coalesce(p_tcb, sig) == OS_TRUE)
     {
-        ENTER_CRITICAL();
+        return;
+    }
+#endif
+    os_msg_queue_put_pure(&(p_tcb->msg_queue), sig);
+}
 
-        add_curr_task_to_delay_list(time_out, OS_TRUE); // Can block indefinitely
-        if (time_out == OS_CFG_DELAY_MAX)
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+/* Called in critical section. Blocks current task till msg queue of p_tcb and msg pool have room,
+returns OS_FALSE if time_out expires first. Interrupts are enabled while blocked */
+static uint8_t task_wait_for_room(task_tcb_t *p_tcb, uint32_t time_out)
+{
+    const uint32_t time_start = tick_count;
+    uint32_t time_left = time_out;
+    uint32_t time_elapsed;
+    list_t *p_wait_list;
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_assert(os_timer_in_hard_cb() == OS_FALSE || time_out == 0u, "OS_ERR_BLOCKING_IN_HARD_TIMER");
+#endif
+    for (;;)
+    {
+        if (p_tcb->msg_queue.size_curr < p_tcb->msg_queue.size_max ||
+            p_tcb->msg_queue.policy == MSG_Q_OVERFLOW_DROP_OLDEST ||
+            p_tcb->msg_queue.policy == MSG_Q_MAILBOX)
         {
-            tcb_curr_ptr->state = TASK_STATE_SUSPENDED_ON_MSG;
+            /* A full queue that recycles its oldest msg needs no new one from pool */
+            if (p_tcb->msg_queue.size_curr != 0u &&
+                p_tcb->msg_queue.size_curr >= p_tcb->msg_queue.size_max)
+            {
+                return OS_TRUE;
+            }
+            if (os_msg_get_pool_free() != 0u)
+            {
+                return OS_TRUE;
+            }
+            p_wait_list = &msg_pool_wait_list;
         }
         else
         {
-            tcb_curr_ptr->state = TASK_STATE_DELAYED_ON_MSG;
+            p_wait_list = &(p_tcb->send_wait_list);
+        }
+        if (time_left == 0u || p_tcb == tcb_curr_ptr)
+        {
+            /* Task can not wait for room in its own queue */
+            return OS_FALSE;
         }
+
+        /* Highest prio sender is at head, the one to wake first */
+        list_item_set_value(&(tcb_curr_ptr->event_list_item), tcb_curr_ptr->prio);
+        os_list_insert(p_wait_list, &(tcb_curr_ptr->event_list_item));
+        add_curr_task_to_delay_list(time_left, OS_TRUE); // Can block indefinitely
         os_cpu_trigger_PendSV();
         EXIT_CRITICAL();
 
-        p_msg = os_msg_queue_get(&(task_tcb_list[tcb_curr_ptr->id]->msg_queue));
-        return p_msg;
+        /* Woken by receiver, msg free or time out, check room again */
+        ENTER_CRITICAL();
+        if (time_out != OS_CFG_DELAY_MAX)
+        {
+            time_elapsed = tick_count - time_start;
+            time_left = (time_elapsed >= time_out) ? 0u : (time_out - time_elapsed);
+        }
+    }
+}
+
+/* Called in critical section */
+static void task_wake_sender(list_t *p_wait_list)
+{
+    if (list_is_empty(p_wait_list) == OS_FALSE)
+    {
+        task_unblock((task_tcb_t *)list_get_owner_of_head_item(p_wait_list));
+    }
+}
+
+uint8_t os_task_post_msg_dynamic_timeout(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size, uint32_t time_out)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+    if (task_wait_for_room(task_tcb_list[des_task_id], time_out) == OS_FALSE)
+    {
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+    os_msg_queue_put_dynamic(&(task_tcb_list[des_task_id]->msg_queue),
+                             sig,
+                             p_content,
+                             msg_size);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+    return OS_TRUE;
+}
+
+uint8_t os_task_post_msg_loaned_timeout(uint8_t des_task_id, int32_t sig, void *p_buf, uint32_t time_out)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+    if (task_wait_for_room(task_tcb_list[des_task_id], time_out) == OS_FALSE)
+    {
+        EXIT_CRITICAL();
+        return OS_FALSE; /* Buffer is still owned by caller */
+    }
+    os_msg_queue_put_loaned(&(task_tcb_list[des_task_id]->msg_queue), sig, p_buf);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+    return OS_TRUE;
+}
+
+uint8_t os_task_post_msg_pure_timeout(uint8_t des_task_id, int32_t sig, uint32_t time_out)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    if (task_sig_coalesce(task_tcb_list[des_task_id], sig) == OS_TRUE)
+    {
+        task_wake_on_msg(task_tcb_list[des_task_id]);
+        EXIT_CRITICAL();
+        return OS_TRUE;
+    }
+#endif
+    if (task_wait_for_room(task_tcb_list[des_task_id], time_out) == OS_FALSE)
+    {
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+    os_msg_queue_put_pure(&(task_tcb_list[des_task_id]->msg_queue), sig);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+    return OS_TRUE;
+}
+#endif
+
+/* Called in critical section, takes head msg of queue of p_tcb */
+static msg_t *task_get_msg(task_tcb_t *p_tcb)
+{
+    msg_t *p_msg;
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+    p_msg = os_msg_queue_get(&(p_tcb->urgent_queue));
+    if (p_msg != NULL)
+    {
+        return p_msg; /* Urgent lane first, senders never wait on it */
+    }
+#endif
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    if (p_tcb->sig_pending != 0u)
+    {
+        /* Pending signals go before queued msgs, lowest signal first */
+        uint32_t idx = task_ctz(p_tcb->sig_pending);
+        p_msg = os_msg_make_pure(p_tcb->sig_coal_first + (int32_t)idx);
+        if (p_msg != NULL)
+        {
+            p_tcb->sig_pending &= ~((uint32_t)1u << idx);
+            return p_msg;
+        }
+        /* Msg pool is empty, signal stays pending and queued msgs are taken meanwhile */
+    }
+#endif
+    p_msg = os_msg_queue_get(&(p_tcb->msg_queue));
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+    if (p_msg != NULL)
+    {
+        /* A slot is free, highest prio sender blocked on this queue takes it */
+        task_wake_sender(&(p_tcb->send_wait_list));
+    }
+#endif
+    return p_msg;
+}
+
+void os_task_post_msg_dynamic(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return;
+    }
+    os_msg_queue_put_dynamic(&(task_tcb_list[des_task_id]->msg_queue),
+                             sig,
+                             p_content,
+                             msg_size);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+}
+
+void os_task_post_msg_loaned(uint8_t des_task_id, int32_t sig, void *p_buf)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        os_msg_loan_return(p_buf); /* Ownership was given, do not leak it */
+        EXIT_CRITICAL();
+        return;
+    }
+    os_msg_queue_put_loaned(&(task_tcb_list[des_task_id]->msg_queue), sig, p_buf);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+}
+
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+void os_task_post_msg_dynamic_urgent(uint8_t des_task_id, int32_t sig, void *p_content, uint8_t msg_size)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return;
+    }
+    os_msg_queue_put_dynamic(&(task_tcb_list[des_task_id]->urgent_queue),
+                             sig,
+                             p_content,
+                             msg_size);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+}
+
+void os_task_post_msg_pure_urgent(uint8_t des_task_id, int32_t sig)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return;
+    }
+    os_msg_queue_put_pure(&(task_tcb_list[des_task_id]->urgent_queue), sig);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+}
+
+void os_task_post_msg_loaned_urgent(uint8_t des_task_id, int32_t sig, void *p_buf)
+{
+    ENTER_CRITICAL();
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        os_msg_loan_return(p_buf); /* Ownership was given, do not leak it */
+        EXIT_CRITICAL();
+        return;
+    }
+    os_msg_queue_put_loaned(&(task_tcb_list[des_task_id]->urgent_queue), sig, p_buf);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+}
+#endif
+
+uint32_t os_task_get_msg_dropped(uint8_t task_id)
+{
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+    return os_msg_queue_get_dropped(&(task_tcb_list[task_id]->msg_queue)) +
+           os_msg_queue_get_dropped(&(task_tcb_list[task_id]->urgent_queue));
+#else
+    return os_msg_queue_get_dropped(&(task_tcb_list[task_id]->msg_queue));
+#endif
+}
+
+void os_task_post_msg_pure(uint8_t des_task_id, int32_t sig)
+{
+    ENTER_CRITICAL();
+#if 0 /* Under testing */
+    if (task_tcb_list[des_task_id] == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return;
+    }
+#endif
+    task_put_pure(task_tcb_list[des_task_id], sig);
+    task_wake_on_msg(task_tcb_list[des_task_id]);
+    EXIT_CRITICAL();
+}
+
+#if (OS_CFG_USE_MSG_PUBSUB == 1u)
+void os_task_subscribe(uint8_t task_id, int32_t sig_first, int32_t sig_last)
+{
+    uint8_t index;
+    if (task_id >= 32u || task_id >= TASK_EOT_ID || sig_first > sig_last)
+    {
+        // OSUniversalError = OS_ERR_MSG_SUB_INVALID;
+        os_assert(0, "OS_ERR_MSG_SUB_INVALID");
+        return;
+    }
+    ENTER_CRITICAL();
+    for (index = 0; index < task_sub_num; index++)
+    {
+        if (task_sub_tbl[index].sig_first == sig_first && task_sub_tbl[index].sig_last == sig_last)
+        {
+            task_sub_tbl[index].task_mask |= ((uint32_t)1u << task_id);
+            EXIT_CRITICAL();
+            return;
+        }
+    }
+    if (task_sub_num >= OS_CFG_MSG_SUB_MAX)
+    {
+        // OSUniversalError = OS_ERR_MSG_SUB_TABLE_FULL;
+        os_assert(0, "OS_ERR_MSG_SUB_TABLE_FULL");
+        EXIT_CRITICAL();
+        return;
+    }
+    task_sub_tbl[task_sub_num].sig_first = sig_first;
+    task_sub_tbl[task_sub_num].sig_last = sig_last;
+    task_sub_tbl[task_sub_num].task_mask = ((uint32_t)1u << task_id);
+    task_sub_num++;
+    EXIT_CRITICAL();
+}
+
+void os_task_unsubscribe(uint8_t task_id, int32_t sig_first, int32_t sig_last)
+{
+    uint8_t index;
+    ENTER_CRITICAL();
+    for (index = 0; index < task_sub_num; index++)
+    {
+        if (task_sub_tbl[index].sig_first == sig_first && task_sub_tbl[index].sig_last == sig_last)
+        {
+            task_sub_tbl[index].task_mask &= ~((uint32_t)1u << task_id);
+            if (task_sub_tbl[index].task_mask == 0u)
+            {
+                /* Range has no subscriber left, last entry takes its place */
+                task_sub_num--;
+                task_sub_tbl[index] = task_sub_tbl[task_sub_num];
+            }
+            break;
+        }
+    }
+    EXIT_CRITICAL();
+}
+
+/* Called in critical section */
+static uint32_t task_get_subscribers(int32_t sig)
+{
+    uint8_t index;
+    uint32_t task_mask = 0u;
+    for (index = 0; index < task_sub_num; index++)
+    {
+        if (sig >= task_sub_tbl[index].sig_first && sig <= task_sub_tbl[index].sig_last)
+        {
+            task_mask |= task_sub_tbl[index].task_mask;
+        }
+    }
+    return task_mask;
+}
+
+uint8_t os_task_publish_loaned(int32_t sig, void *p_buf)
+{
+    uint32_t task_mask;
+    uint8_t num_of_sub = 0u;
+    uint8_t task_id;
+
+    ENTER_CRITICAL();
+    task_mask = task_get_subscribers(sig);
+    for (task_id = 0; (task_mask >> task_id) != 0u; task_id++)
+    {
+        num_of_sub += (uint8_t)((task_mask >> task_id) & 1u);
+    }
+    if (num_of_sub == 0u)
+    {
+        os_msg_loan_return(p_buf);
+        EXIT_CRITICAL();
+        return 0u;
+    }
+
+    /* One reference per subscriber, the one of sender goes to the first */
+    os_msg_loan_add_ref(p_buf, num_of_sub - 1u);
+    while (task_mask != 0u)
+    {
+        task_id = (uint8_t)task_ctz(task_mask);
+        task_mask &= task_mask - 1u;
+        os_msg_queue_put_loaned(&(task_tcb_list[task_id]->msg_queue), sig, p_buf);
+        task_wake_on_msg(task_tcb_list[task_id]);
+    }
+    EXIT_CRITICAL();
+    return num_of_sub;
+}
+
+uint8_t os_task_publish(int32_t sig, void *p_content, uint16_t size)
+{
+    uint32_t task_mask;
+    uint8_t num_of_sub = 0u;
+    uint8_t task_id;
+    void *p_buf;
+
+    if (size != 0u)
+    {
+        /* One copy for all subscribers, done out of critical section */
+        p_buf = os_msg_loan(size);
+        if (p_buf == NULL)
+        {
+            return 0u;
+        }
+        memcpy(p_buf, p_content, size);
+        return os_task_publish_loaned(sig, p_buf);
+    }
+
+    /* No payload, pure msg to each subscriber */
+    ENTER_CRITICAL();
+    task_mask = task_get_subscribers(sig);
+    while (task_mask != 0u)
+    {
+        task_id = (uint8_t)task_ctz(task_mask);
+        task_mask &= task_mask - 1u;
+        task_put_pure(task_tcb_list[task_id], sig);
+        task_wake_on_msg(task_tcb_list[task_id]);
+        num_of_sub++;
+    }
+    EXIT_CRITICAL();
+    return num_of_sub;
+}
+#endif
+
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u) || (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+void os_task_wake_msg_pool_waiter(void)
+{
+    ENTER_CRITICAL();
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    if (list_is_empty(&sig_wait_list) == OS_FALSE)
+    {
+        /* Receiver can make the msg of its pending signal now, a post of the same signal would not wake it */
+        task_unblock((task_tcb_t *)list_get_owner_of_head_item(&sig_wait_list));
+        EXIT_CRITICAL();
+        return;
+    }
+#endif
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+    task_wake_sender(&msg_pool_wait_list);
+#endif
+    EXIT_CRITICAL();
+}
+#endif
+
+/* Called in critical section, current task blocks till a msg is posted or time_out expires */
+static void task_block_on_msg(uint32_t time_out)
+{
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    if (tcb_curr_ptr->sig_pending != 0u && os_msg_get_pool_free() == 0u)
+    {
+        /* Pending signal had no msg to be taken in, wait for a free msg as well */
+        list_item_set_value(&(tcb_curr_ptr->event_list_item), tcb_curr_ptr->prio);
+        os_list_insert(&sig_wait_list, &(tcb_curr_ptr->event_list_item));
+    }
+#endif
+    add_curr_task_to_delay_list(time_out, OS_TRUE); // Can block indefinitely
+    if (time_out == OS_CFG_DELAY_MAX)
+    {
+        tcb_curr_ptr->state = TASK_STATE_SUSPENDED_ON_MSG;
     }
     else
+    {
+        tcb_curr_ptr->state = TASK_STATE_DELAYED_ON_MSG;
+    }
+    os_cpu_trigger_PendSV();
+    EXIT_CRITICAL();
+
+    ENTER_CRITICAL();
+}
+
+msg_t *os_task_wait_for_msg(uint32_t time_out)
+{
+    msg_t *p_msg;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_assert(os_timer_in_hard_cb() == OS_FALSE || time_out == 0u, "OS_ERR_BLOCKING_IN_HARD_TIMER");
+#endif
+    /* Queue is checked and task blocks in one critical section, so no post is missed in between */
+    ENTER_CRITICAL();
+    p_msg = task_get_msg(tcb_curr_ptr);
+    if (time_out > (uint32_t)0U && p_msg == NULL)
+    {
+        task_block_on_msg(time_out);
+        p_msg = task_get_msg(tcb_curr_ptr);
+    }
+    EXIT_CRITICAL();
+    return p_msg;
+}
+
+#if (OS_CFG_USE_MSG_WAIT_SIG == 1u)
+/* Called in critical section. Nothing matched when task blocked and posts only add at tail,
+so tail (and coalesced signals) are all to check */
+static uint8_t task_has_match(task_tcb_t *p_tcb)
+{
+    msg_t *p_msg_tail = p_tcb->msg_queue.tail_ptr;
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    msg_t msg_sig;
+    uint32_t sig_bits = p_tcb->sig_pending;
+#endif
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+    msg_t *p_urgent_tail = p_tcb->urgent_queue.tail_ptr;
+
+    if (p_urgent_tail != NULL && p_tcb->pf_match(p_urgent_tail, p_tcb->match_arg) == OS_TRUE)
+    {
+        return OS_TRUE;
+    }
+#endif
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+
+    msg_sig.type = MSG_TYPE_PURE;
+    while (sig_bits != 0u)
+    {
+        msg_sig.sig = p_tcb->sig_coal_first + (int32_t)task_ctz(sig_bits);
+        if (p_tcb->pf_match(&msg_sig, p_tcb->match_arg) == OS_TRUE)
+        {
+            return OS_TRUE;
+        }
+        sig_bits &= sig_bits - 1u;
+    }
+#endif
+    if (p_msg_tail != NULL && p_tcb->pf_match(p_msg_tail, p_tcb->match_arg) == OS_TRUE)
+    {
+        return OS_TRUE;
+    }
+    return OS_FALSE;
+}
+
+/* Called in critical section, takes first msg of p_tcb that matches */
+static msg_t *task_get_msg_match(task_tcb_t *p_tcb, msg_match_t pf_match, void *p_arg)
+{
+    msg_t *p_msg;
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    msg_t msg_sig;
+    uint32_t sig_bits = p_tcb->sig_pending;
+    uint32_t idx;
+#endif
+#if (OS_CFG_USE_MSG_URGENT == 1u)
+    p_msg = os_msg_queue_get_match(&(p_tcb->urgent_queue), pf_match, p_arg);
+    if (p_msg != NULL)
     {
         return p_msg;
     }
+#endif
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 1u)
+    msg_sig.type = MSG_TYPE_PURE;
+    while (sig_bits != 0u)
+    {
+        idx = task_ctz(sig_bits);
+        msg_sig.sig = p_tcb->sig_coal_first + (int32_t)idx;
+        if (pf_match(&msg_sig, p_arg) == OS_TRUE)
+        {
+            p_msg = os_msg_make_pure(msg_sig.sig);
+            if (p_msg != NULL)
+            {
+                p_tcb->sig_pending &= ~((uint32_t)1u << idx);
+                return p_msg;
+            }
+            break; /* Msg pool is empty, signal stays pending */
+        }
+        sig_bits &= sig_bits - 1u;
+    }
+#endif
+    p_msg = os_msg_queue_get_match(&(p_tcb->msg_queue), pf_match, p_arg);
+#if (OS_CFG_USE_MSG_POST_TIMEOUT == 1u)
+    if (p_msg != NULL)
+    {
+        task_wake_sender(&(p_tcb->send_wait_list));
+    }
+#endif
+    return p_msg;
+}
+
+msg_t *os_task_wait_for_msg_match(msg_match_t pf_match, void *p_arg, uint32_t time_out)
+{
+    const uint32_t time_start = tick_count;
+    uint32_t time_left = time_out;
+    uint32_t time_elapsed;
+    msg_t *p_msg;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_assert(os_timer_in_hard_cb() == OS_FALSE || time_out == 0u, "OS_ERR_BLOCKING_IN_HARD_TIMER");
+#endif
+    ENTER_CRITICAL();
+    for (;;)
+    {
+        p_msg = task_get_msg_match(tcb_curr_ptr, pf_match, p_arg);
+        if (p_msg != NULL || time_left == 0u)
+        {
+            break;
+        }
+        tcb_curr_ptr->pf_match = pf_match;
+        tcb_curr_ptr->match_arg = p_arg;
+        task_block_on_msg(time_left);
+        tcb_curr_ptr->pf_match = NULL;
+
+        /* Woken by a match or time out, a full queue may have recycled the match meanwhile */
+        if (time_out != OS_CFG_DELAY_MAX)
+        {
+            time_elapsed = tick_count - time_start;
+            time_left = (time_elapsed >= time_out) ? 0u : (time_out - time_elapsed);
+        }
+    }
+    EXIT_CRITICAL();
+    return p_msg;
+}
+
+typedef struct
+{
+    int32_t sig;
+    uint32_t sig_mask;
+} task_sig_mask_t;
+
+static uint8_t task_match_sig_mask(msg_t *p_msg, void *p_arg)
+{
+    task_sig_mask_t *p_sig_mask = (task_sig_mask_t *)p_arg;
+    return ((((uint32_t)p_msg->sig ^ (uint32_t)p_sig_mask->sig) & p_sig_mask->sig_mask) == 0u) ? OS_TRUE : OS_FALSE;
+}
+
+msg_t *os_task_wait_for_sig(int32_t sig, uint32_t sig_mask, uint32_t time_out)
+{
+    task_sig_mask_t sig_mask_arg; /* Lives on waiter stack while it waits */
+    sig_mask_arg.sig = sig;
+    sig_mask_arg.sig_mask = sig_mask;
+    return os_task_wait_for_msg_match(task_match_sig_mask, &sig_mask_arg, time_out);
+}
+#endif
+
+#if (OS_CFG_USE_MSG_RPC == 1u)
+enum
+{
+    TASK_CALL_IDLE = 0,
+    TASK_CALL_WAITING,
+    TASK_CALL_REPLIED
+};
+
+uint8_t os_task_call(uint8_t des_task_id,
+                     int32_t sig,
+                     void *p_req,
+                     uint8_t req_len,
+                     void *p_rsp,
+                     uint16_t *p_rsp_len,
+                     uint32_t time_out)
+{
+    const uint32_t time_start = tick_count;
+    uint32_t time_left = time_out;
+    uint32_t time_elapsed;
+    task_tcb_t *p_tcb_dst = task_tcb_list[des_task_id];
+    msg_t *p_msg;
+    uint8_t is_replied;
+
+    ENTER_CRITICAL();
+    if (p_tcb_dst == tcb_curr_ptr)
+    {
+        // OSUniversalError = OS_ERR_TASK_POST_MSG_TO_ITSELF;
+        os_assert(0, "OS_ERR_TASK_POST_MSG_TO_ITSELF");
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+    if (req_len != 0u)
+    {
+        p_msg = os_msg_queue_put_dynamic(&(p_tcb_dst->msg_queue), sig, p_req, req_len);
+    }
+    else
+    {
+        p_msg = os_msg_queue_put_pure(&(p_tcb_dst->msg_queue), sig);
+    }
+    if (p_msg == NULL)
+    {
+        EXIT_CRITICAL();
+        return OS_FALSE;
+    }
+    tcb_curr_ptr->call_seq++;
+    tcb_curr_ptr->call_state = TASK_CALL_WAITING;
+    tcb_curr_ptr->rsp_ptr = (uint8_t *)p_rsp;
+    tcb_curr_ptr->rsp_size = *p_rsp_len;
+    p_msg->src_task_id = tcb_curr_ptr->id;
+    p_msg->call_seq = tcb_curr_ptr->call_seq;
+    task_wake_on_msg(p_tcb_dst);
+
+    /* Not on msg state, so msgs posted to caller meanwhile do not wake it */
+    while (tcb_curr_ptr->call_state != TASK_CALL_REPLIED && time_left != 0u)
+    {
+        add_curr_task_to_delay_list(time_left, OS_TRUE); // Can block indefinitely
+        os_cpu_trigger_PendSV();
+        EXIT_CRITICAL();
+
+        ENTER_CRITICAL();
+        if (time_out != OS_CFG_DELAY_MAX)
+        {
+            time_elapsed = tick_count - time_start;
+            time_left = (time_elapsed >= time_out) ? 0u : (time_out - time_elapsed);
+        }
+    }
+    is_replied = (tcb_curr_ptr->call_state == TASK_CALL_REPLIED) ? OS_TRUE : OS_FALSE;
+    *p_rsp_len = (is_replied == OS_TRUE) ? tcb_curr_ptr->rsp_size : 0u;
+    tcb_curr_ptr->call_state = TASK_CALL_IDLE;
+    EXIT_CRITICAL();
+    return is_replied;
+}
+
+uint8_t os_task_reply(msg_t *p_msg, void *p_data, uint16_t len)
+{
+    task_tcb_t *p_tcb;
+
+    if (p_msg->src_task_id == MSG_TASK_ID_NONE)
+    {
+        // OSUniversalError = OS_ERR_MSG_NOT_A_CALL;
+        os_assert(0, "OS_ERR_MSG_NOT_A_CALL");
+        return OS_FALSE;
+    }
+    ENTER_CRITICAL();
+    p_tcb = task_tcb_list[p_msg->src_task_id];
+    if (p_tcb->call_state != TASK_CALL_WAITING || p_tcb->call_seq != p_msg->call_seq)
+    {
+        EXIT_CRITICAL();
+        return OS_FALSE; /* Caller has given up */
+    }
+    if (len > p_tcb->rsp_size)
+    {
+        len = p_tcb->rsp_size; /* Reply is cut to caller buffer */
+    }
+    memcpy(p_tcb->rsp_ptr, p_data, len);
+    p_tcb->rsp_size = len;
+    p_tcb->call_state = TASK_CALL_REPLIED;
+    p_msg->src_task_id = MSG_TASK_ID_NONE; /* One reply per call */
+    if (p_tcb->state == TASK_STATE_DELAYED || p_tcb->state == TASK_STATE_SUSPENDED)
+    {
+        task_unblock(p_tcb);
+    }
+    EXIT_CRITICAL();
+    return OS_TRUE;
+}
+#endif
+
+/* Called in critical section, detaches up to num msgs of p_tcb as a chain */
+static uint8_t task_get_msgs(task_tcb_t *p_tcb, msg_t **pp_msgs, uint8_t num)
+{
+    msg_t *p_msg;
+    msg_t *p_msg_tail = NULL;
+    uint8_t num_got = 0u;
+
+    *pp_msgs = NULL;
+    while (num_got < num)
+    {
+        p_msg = task_get_msg(p_tcb);
+        if (p_msg == NULL)
+        {
+            break;
+        }
+        p_msg->next = NULL;
+        if (p_msg_tail == NULL)
+        {
+            *pp_msgs = p_msg;
+        }
+        else
+        {
+            p_msg_tail->next = p_msg;
+        }
+        p_msg_tail = p_msg;
+        num_got++;
+    }
+    return num_got;
+}
+
+uint8_t os_task_wait_for_msgs(msg_t **pp_msgs, uint8_t num, uint32_t time_out)
+{
+    uint8_t num_got;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_assert(os_timer_in_hard_cb() == OS_FALSE || time_out == 0u, "OS_ERR_BLOCKING_IN_HARD_TIMER");
+#endif
+    ENTER_CRITICAL();
+    num_got = task_get_msgs(tcb_curr_ptr, pp_msgs, num);
+    if (time_out > (uint32_t)0U && num_got == 0u && num != 0u)
+    {
+        task_block_on_msg(time_out);
+        num_got = task_get_msgs(tcb_curr_ptr, pp_msgs, num);
+    }
+    EXIT_CRITICAL();
+    return num_got;
 }
\ No newline at end of file
@@ -4,75 +4,106 @@
 #include "os_msg.h"
 #include "task_list.h"
 #include "os_list.h"
+#include "os_wheel.h"
+#include "os_cpu.h"
+#include "os_pool.h"
 
 #define REF_TASK_TIMER_ID               ((task_id_t)TASK_EOT_ID + 1u)
 
-static os_timer_t timer_pool[OS_CFG_TIMER_POOL_SIZE];
-static os_timer_t *free_list_timer_pool;
-static uint8_t timer_pool_used;
+static os_timer_t timer_pool_buf[OS_CFG_TIMER_POOL_SIZE];
+static pool_t timer_pool;
 
 static uint32_t timer_counter;
 
+#if (OS_CFG_USE_TIMER_WHEEL == 1u)
+static wheel_t timer_wheel; /* Follows tick as timer task processes it, tick overflow is handled by the wheel itself */
+#else
 static list_t timer_list_1;
 static list_t timer_list_2;
 
 static list_t *volatile timer_list_ptr; /* Current */
 static list_t *volatile overflow_timer_list_ptr;
+#endif
 
 static volatile uint32_t next_tick_to_unblock_timer = (uint32_t)OS_CFG_DELAY_MAX;
+static volatile uint8_t timer_is_armed = OS_FALSE; /* Any tick value is a valid trigger, so "no timer" is kept apart */
 
-static void timer_pool_init()
-{
-    uint8_t index;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+static wheel_t timer_hard_wheel; /* Moved every tick by tick interrupt */
+static volatile uint8_t timer_hard_cb_running;
+#endif
 
-    free_list_timer_pool = (os_timer_t *)timer_pool;
+/* Slack statistics, a wakeup is one processing of expired timers */
+static uint32_t timer_wakeup_saved;
+static uint16_t timer_wakeup_fired;
+static uint16_t timer_wakeup_moved;
 
-    for (index = 0; index < OS_CFG_TIMER_POOL_SIZE; index++)
-    {
-        if (index == (OS_CFG_TIMER_POOL_SIZE - 1))
-        {
-            timer_pool[index].next = NULL;
-        }
-        else
-        {
-            timer_pool[index].next = (os_timer_t *)&timer_pool[index + 1];
-        }
-    }
+#if (OS_CFG_USE_TIMER_WHEEL == 0u)
+static uint32_t timer_last_time; /* Tick timer lists were last processed at, to detect tick overflow */
+#endif
 
-    timer_pool_used = 0;
-}
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+/* Callbacks of timers expired in tick interrupt, run later by idle task */
+static timer_cb timer_cb_queue[OS_CFG_TIMER_CB_Q_SIZE];
+static uint8_t timer_cb_queue_head;
+static volatile uint8_t timer_cb_queue_count;
+#endif
 
 static void init_timer_lists(void)
 {
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    os_wheel_init(&timer_hard_wheel, os_task_get_tick());
+#endif
+#if (OS_CFG_USE_TIMER_WHEEL == 1u)
+    os_wheel_init(&timer_wheel, os_task_get_tick());
+#else
     /* Initialize lists */
     os_list_init(&timer_list_1);
     os_list_init(&timer_list_2);
     timer_list_ptr = &timer_list_1;
     overflow_timer_list_ptr = &timer_list_2;
     /********************/
+#endif
 }
 
+#if (OS_CFG_USE_TIMER_WHEEL == 0u)
 static void timer_switch_lists()
 {
     list_t *p_list_temp;
     p_list_temp = timer_list_ptr;
     timer_list_ptr = overflow_timer_list_ptr;
     overflow_timer_list_ptr = p_list_temp;
+}
+#endif
 
-    if (list_is_empty(timer_list_ptr) == OS_TRUE)
+static void add_timer_to_list(os_timer_t *p_timer)
+{
+    ENTER_CRITICAL();
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    if (p_timer->hard == OS_TRUE)
     {
-        next_tick_to_unblock_timer = OS_CFG_DELAY_MAX;
+        os_wheel_insert(&timer_hard_wheel, &(p_timer->timer_list_item));
+        EXIT_CRITICAL();
+        return;
     }
-    else
+#endif
+#if (OS_CFG_USE_TIMER_WHEEL == 1u)
     {
-        next_tick_to_unblock_timer = 0u;
+        uint32_t tick_to_trigger = list_item_get_value(&(p_timer->timer_list_item));
+
+        /* O(1), wheel time may lag tick till timer task runs but trigger tick is absolute */
+        os_wheel_insert(&timer_wheel, &(p_timer->timer_list_item));
+        if ((timer_is_armed == OS_FALSE) ||
+            ((tick_to_trigger - timer_wheel.time) < (next_tick_to_unblock_timer - timer_wheel.time)))
+        {
+            next_tick_to_unblock_timer = tick_to_trigger;
+            timer_is_armed = OS_TRUE;
+        }
     }
-}
-static void add_timer_to_list(os_timer_t *p_timer)
-{
-    ENTER_CRITICAL();
+#else
     {
-        const uint32_t const_tick = os_task_get_tick();
+        /* Lists follow tick round of last processing, which may lag tick till timer task runs */
+        const uint32_t const_tick = timer_last_time;
         uint32_t tick_to_trigger = list_item_get_value(&(p_timer->timer_list_item));
         if (tick_to_trigger < const_tick)
         {
@@ -87,25 +118,32 @@ static void add_timer_to_list(os_timer_t *p_timer)
             os_list_insert(timer_list_ptr, &(p_timer->timer_list_item));
         }
     }
+#endif
     EXIT_CRITICAL();
 }
 static void update_next_tick_to_unblock()
 {
+#if (OS_CFG_USE_TIMER_WHEEL == 0u)
+    list_t *p_list = timer_list_ptr;
     os_timer_t *p_timer;
-    uint32_t item_value;
-    if (list_is_empty(timer_list_ptr) == OS_TRUE)
+
+    if (list_is_empty(p_list) == OS_TRUE)
     {
-        next_tick_to_unblock_timer = OS_CFG_DELAY_MAX;
+        /* Timers past tick overflow are still to wait for */
+        p_list = overflow_timer_list_ptr;
+    }
+    if (list_is_empty(p_list) == OS_TRUE)
+    {
+        timer_is_armed = OS_FALSE;
     }
     else
     {
-        p_timer = list_get_owner_of_head_item(timer_list_ptr);
-        item_value = list_item_get_value(&(p_timer->timer_list_item));
-        if (item_value < next_tick_to_unblock_timer)
-        {
-            next_tick_to_unblock_timer = item_value;
-        }
+        p_timer = list_get_owner_of_head_item(p_list);
+        next_tick_to_unblock_timer = list_item_get_value(&(p_timer->timer_list_item));
+        timer_is_armed = OS_TRUE;
     }
+#endif
+    /* Wheel mode: add_timer_to_list already keeps it, processing recomputes it */
 }
 
 os_timer_t *os_timer_create(timer_id_t id, int32_t sig, timer_cb func_cb, uint8_t des_task_id, uint32_t period, timer_type_t type)
@@ -123,12 +161,6 @@ os_timer_t *os_timer_create(timer_id_t id, int32_t sig, timer_cb func_cb, uint8_
         os_assert(0, "OS_ERR_CAN_NOT_SET_DES_TO_ITSELF");
         return NULL;
     }
-    if (timer_pool_used >= OS_CFG_TIMER_POOL_SIZE)
-    {
-        // OSUniversalError = OS_ERR_TIMER_POOL_IS_FULL;
-        os_assert(0, "OS_ERR_TIMER_POOL_IS_FULL");
-        return NULL;
-    }
     if (period == 0u && type == TIMER_PERIODIC)
     {
         // OSUniversalError = OS_ERR_TIMER_NOT_ACECPT_ZERO_PERIOD;
@@ -136,14 +168,24 @@ os_timer_t *os_timer_create(timer_id_t id, int32_t sig, timer_cb func_cb, uint8_
         return NULL;
     }
     os_timer_t *p_timer;
-    p_timer = free_list_timer_pool;
-    free_list_timer_pool = p_timer->next;
-    timer_pool_used++;
+    p_timer = (os_timer_t *)os_pool_get(&timer_pool);
+    if (p_timer == NULL)
+    {
+        // OSUniversalError = OS_ERR_TIMER_POOL_IS_FULL;
+        os_assert(0, "OS_ERR_TIMER_POOL_IS_FULL");
+        return NULL;
+    }
 
     p_timer->id = id;
     p_timer->sig = sig;
     p_timer->func_cb = func_cb;
     p_timer->des_task_id = des_task_id;
+    p_timer->overrun_policy = TIMER_OVERRUN_SKIP;
+    p_timer->overrun_count = 0u;
+    p_timer->slack = 0u;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    p_timer->hard = OS_FALSE;
+#endif
 
     switch (type)
     {
@@ -171,105 +213,501 @@ void os_timer_remove(os_timer_t *p_timer)
 {
     ENTER_CRITICAL();
 
-    p_timer->next = free_list_timer_pool;
-    free_list_timer_pool = p_timer;
-    timer_pool_used--;
-
     if (list_item_get_list_contain(&(p_timer->timer_list_item)) != NULL)
         os_list_remove(&(p_timer->timer_list_item));
 
+    os_pool_put(&timer_pool, p_timer);
+
     EXIT_CRITICAL();
 }
 
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+os_timer_t *os_timer_create_hard(timer_id_t id, timer_cb func_cb, uint32_t period, timer_type_t type)
+{
+    os_timer_t *p_timer;
+    if (func_cb == NULL)
+    {
+        // OSUniversalError = OS_ERR_TIMER_HARD_NEED_CALLBACK;
+        os_assert(0, "OS_ERR_TIMER_HARD_NEED_CALLBACK");
+        return NULL;
+    }
+    p_timer = os_timer_create(id, 0, func_cb, 0u, period, type);
+    if (p_timer != NULL)
+    {
+        p_timer->hard = OS_TRUE;
+        p_timer->late_min = 0xFFFFFFFFu;
+        p_timer->late_max = 0u;
+        p_timer->late_count = 0u;
+        p_timer->late_sum = 0u;
+    }
+    return p_timer;
+}
+#endif
+
 void os_timer_init(void)
 {
-    timer_pool_init();
+    os_pool_create(&timer_pool, timer_pool_buf, sizeof(os_timer_t), OS_CFG_TIMER_POOL_SIZE);
     init_timer_lists();
     next_tick_to_unblock_timer = OS_CFG_DELAY_MAX;
-    /*TODO: Create a task for timer here, or maybe in os_task.c and call os_timer_processing*/
+    timer_is_armed = OS_FALSE;
+    timer_wakeup_saved = 0u;
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    timer_hard_cb_running = OS_FALSE;
+#endif
+#if (OS_CFG_USE_TIMER_WHEEL == 0u)
+    timer_last_time = os_task_get_tick();
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+    timer_cb_queue_head = 0u;
+    timer_cb_queue_count = 0u;
+#endif
 }
-void os_timer_processing()
+uint8_t os_timer_get_next_tick(uint32_t *p_tick)
+{
+    *p_tick = next_tick_to_unblock_timer;
+    return timer_is_armed;
+}
+
+#if (OS_CFG_USE_TIMER_TASK == 0u)
+/* Runs in tick interrupt */
+static void timer_defer_cb(timer_cb func_cb)
+{
+    if (timer_cb_queue_count >= OS_CFG_TIMER_CB_Q_SIZE)
+    {
+        // OSUniversalError = OS_ERR_TIMER_CB_QUEUE_IS_FULL;
+        os_assert(0, "OS_ERR_TIMER_CB_QUEUE_IS_FULL");
+        return;
+    }
+    timer_cb_queue[(timer_cb_queue_head + timer_cb_queue_count) % OS_CFG_TIMER_CB_Q_SIZE] = func_cb;
+    timer_cb_queue_count++;
+}
+#endif
+
+static void timer_fire(os_timer_t *p_timer)
+{
+    if (p_timer->func_cb != NULL)
+    {
+#if (OS_CFG_USE_TIMER_TASK == 1u)
+        p_timer->func_cb();
+#else
+        timer_defer_cb(p_timer->func_cb);
+#endif
+    }
+    else
+        os_task_post_msg_pure(p_timer->des_task_id, p_timer->sig);
+}
+
+/* Trigger tick is the tick in [expiry, expiry + slack] with most low zero bits. Timers with
+overlapping windows pick the same tick, so they are expired in one wakeup. O(1), no list walk */
+static void timer_set_expiry(os_timer_t *p_timer, uint32_t expiry)
+{
+    uint32_t limit = expiry + p_timer->slack;
+    uint32_t mask = expiry ^ limit;
+
+    /* Every bit below highest bit that differs */
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    mask >>= 1;
+
+    p_timer->expiry = expiry;
+    list_item_set_value(&(p_timer->timer_list_item), limit & ~mask);
+}
+
+/* Count a timer fired in this wakeup, it is "moved" when slack took it off its own tick */
+static void timer_count_fired(os_timer_t *p_timer)
+{
+    timer_wakeup_fired++;
+    if (list_item_get_value(&(p_timer->timer_list_item)) != p_timer->expiry)
+    {
+        timer_wakeup_moved++;
+    }
+}
+
+/* Each moved timer fired with others would have needed its own wakeup */
+static void timer_count_wakeup(void)
+{
+    if (timer_wakeup_fired > 1u)
+    {
+        timer_wakeup_saved += (timer_wakeup_moved < timer_wakeup_fired) ? timer_wakeup_moved : (uint32_t)(timer_wakeup_fired - 1u);
+    }
+    timer_wakeup_fired = 0u;
+    timer_wakeup_moved = 0u;
+}
+
+/* Re-arm periodic timer from the deadline it just fired for, not from time it was processed.
+Timer lists must already be at this processing's time */
+static void timer_rearm(os_timer_t *p_timer)
+{
+    uint32_t deadline = p_timer->expiry;
+    const uint32_t const_tick = os_task_get_tick(); /* Callbacks before may have taken time */
+    uint32_t missed = (const_tick - deadline) / p_timer->period; /* Whole periods missed */
+    uint32_t idx;
+
+    p_timer->overrun_count += missed;
+    switch (p_timer->overrun_policy)
+    {
+    case TIMER_OVERRUN_CATCH_UP:
+        for (idx = 0u; idx < missed; idx++)
+        {
+            timer_fire(p_timer);
+        }
+        deadline += (missed + 1u) * p_timer->period;
+        break;
+    case TIMER_OVERRUN_REALIGN:
+        deadline = const_tick + p_timer->period;
+        break;
+    case TIMER_OVERRUN_SKIP:
+    default:
+        deadline += (missed + 1u) * p_timer->period;
+        break;
+    }
+    timer_set_expiry(p_timer, deadline);
+    add_timer_to_list(p_timer);
+}
+
+#if (OS_CFG_USE_TIMER_WHEEL == 1u)
+/* Fire every timer expired till time_now */
+static void timer_expire(uint32_t time_now)
 {
-    msg_t *p_msg;
     os_timer_t *p_timer;
-    uint32_t item_value;
-    static uint32_t last_time = (uint32_t)0U;
-    uint32_t time_now = os_task_get_tick();
-    if (time_now < last_time)
+    list_t *p_due_list;
+    uint32_t delta;
+
+    ENTER_CRITICAL();
+    /* Catch wheel up with tick, jumping over ticks it has nothing to do */
+    while (timer_wheel.time != time_now)
     {
-        /* Overflown */
-        timer_switch_lists();
+        os_wheel_skip(&timer_wheel, time_now - timer_wheel.time - 1u);
+        p_due_list = os_wheel_tick(&timer_wheel);
+        while (list_is_empty(p_due_list) == OS_FALSE)
+        {
+            p_timer = list_get_owner_of_head_item(p_due_list);
+            os_list_remove(&(p_timer->timer_list_item));
+            timer_count_fired(p_timer);
+            EXIT_CRITICAL();
+
+            timer_fire(p_timer);
+            if (p_timer->period != 0)
+                timer_rearm(p_timer);
+            else
+                os_timer_remove(p_timer); /* One shot */
+
+            ENTER_CRITICAL();
+        }
+    }
+    delta = os_wheel_get_next_delta(&timer_wheel);
+    timer_is_armed = (delta != OS_CFG_DELAY_MAX) ? OS_TRUE : OS_FALSE;
+    next_tick_to_unblock_timer = time_now + delta; /* May wrap, only its distance from wheel time is used */
+    timer_count_wakeup();
+    EXIT_CRITICAL();
+}
+
+static uint8_t timer_is_due(uint32_t time_now)
+{
+    /* Wheel lags tick, compare distances from wheel time so tick overflow does not matter */
+    if (timer_is_armed == OS_FALSE)
+    {
+        return OS_FALSE;
     }
-    if (time_now >= next_tick_to_unblock_timer)
+    return (time_now - timer_wheel.time) >= (next_tick_to_unblock_timer - timer_wheel.time) ? OS_TRUE : OS_FALSE;
+}
+#else
+/* Fire every timer in p_list expired at time_limit */
+static void timer_expire_list(list_t *p_list, uint32_t time_limit)
+{
+    os_timer_t *p_timer;
+    uint32_t item_value;
+    for (;;)
     {
-        for (;;)
+        if (list_is_empty(p_list) == OS_TRUE)
         {
-            if (list_is_empty(timer_list_ptr) == OS_TRUE)
+            break;
+        }
+        else
+        {
+            p_timer = list_get_owner_of_head_item(p_list);
+            item_value = list_item_get_value(&(p_timer->timer_list_item));
+            if (item_value > time_limit)
             {
-                next_tick_to_unblock_timer = OS_CFG_DELAY_MAX;
+                /* Stop condition */
                 break;
             }
-            else
+            os_list_remove(&(p_timer->timer_list_item));
+            timer_count_fired(p_timer);
+
+            timer_fire(p_timer);
+            if (p_timer->period != 0)
             {
-                p_timer = list_get_owner_of_head_item(timer_list_ptr);
-                item_value = list_item_get_value(&(p_timer->timer_list_item));
-                if (item_value > time_now)
-                {
-                    /* Stop condition */
-                    next_tick_to_unblock_timer = item_value;
-                    break;
-                }
-                os_list_remove(&(p_timer->timer_list_item));
-
-                if (p_timer->func_cb != NULL)
-                    p_timer->func_cb();
-                else
-                    os_task_post_msg_pure(p_timer->des_task_id, p_timer->sig);
-                if (p_timer->period != 0)
-                {
-                    list_item_set_value(&(p_timer->timer_list_item), p_timer->period + time_now);
-                    add_timer_to_list(p_timer);
-                }
-                else
-                    os_timer_remove(p_timer); /* One shot */
-                update_next_tick_to_unblock();
+                timer_rearm(p_timer);
             }
+            else
+                os_timer_remove(p_timer); /* One shot */
         }
     }
-    last_time = time_now;
-    p_msg = os_task_wait_for_msg(next_tick_to_unblock_timer - time_now);
+}
+
+/* Fire every timer expired till time_now */
+static void timer_expire(uint32_t time_now)
+{
+    uint8_t is_overflown = (time_now < timer_last_time) ? OS_TRUE : OS_FALSE;
+
+    /* Set before expiring, re-armed timers are placed against this tick round */
+    timer_last_time = time_now;
+    if (is_overflown == OS_TRUE)
+    {
+        timer_switch_lists();
+        /* Timers left in previous list expired before tick wrapped (late timer task or tickless jump) */
+        timer_expire_list(overflow_timer_list_ptr, OS_CFG_DELAY_MAX);
+    }
+    timer_expire_list(timer_list_ptr, time_now);
+    update_next_tick_to_unblock();
+    timer_count_wakeup();
+}
+
+static uint8_t timer_is_due(uint32_t time_now)
+{
+    if (time_now < timer_last_time)
+    {
+        return OS_TRUE; /* Overflown, lists must be switched */
+    }
+    if (timer_is_armed == OS_FALSE)
+    {
+        return OS_FALSE;
+    }
+    /* Next timer may be past tick overflow, compare distances from last processing */
+    return ((time_now - timer_last_time) >= (next_tick_to_unblock_timer - timer_last_time)) ? OS_TRUE : OS_FALSE;
+}
+#endif
+
+#if (OS_CFG_USE_TIMER_TASK == 1u)
+/* Ticks timer task may wait from time_now, 0 if next timer is already due. Both ticks are taken
+as distances from last processing, so tick overflow does not matter */
+static uint32_t timer_get_wait(uint32_t time_now)
+{
+#if (OS_CFG_USE_TIMER_WHEEL == 1u)
+    const uint32_t time_base = timer_wheel.time;
+#else
+    const uint32_t time_base = timer_last_time;
+#endif
+    if (timer_is_armed == OS_FALSE)
+    {
+        return OS_CFG_DELAY_MAX; /* Till a timer is started */
+    }
+    if ((time_now - time_base) >= (next_tick_to_unblock_timer - time_base))
+    {
+        return 0u;
+    }
+    return next_tick_to_unblock_timer - time_now;
+}
+
+void os_timer_processing()
+{
+    msg_t *p_msg;
+    uint32_t time_now = os_task_get_tick();
+
+    if (timer_is_due(time_now) == OS_TRUE)
+    {
+        timer_expire(time_now);
+    }
+    time_now = os_task_get_tick(); /* Wait from now, callbacks may have taken time */
+    p_msg = os_task_wait_for_msg(timer_get_wait(time_now));
     if (p_msg != NULL)
         os_msg_free(p_msg);
 }
+#else
+void os_timer_tick_processing(void)
+{
+    uint32_t time_now = os_task_get_tick();
+
+    if (timer_is_due(time_now) == OS_TRUE)
+    {
+        timer_expire(time_now);
+    }
+}
+
+void os_timer_run_deferred(void)
+{
+    timer_cb func_cb;
+    for (;;)
+    {
+        ENTER_CRITICAL();
+        if (timer_cb_queue_count == 0u)
+        {
+            EXIT_CRITICAL();
+            break;
+        }
+        func_cb = timer_cb_queue[timer_cb_queue_head];
+        timer_cb_queue_head = (uint8_t)((timer_cb_queue_head + 1u) % OS_CFG_TIMER_CB_Q_SIZE);
+        timer_cb_queue_count--;
+        EXIT_CRITICAL();
+
+        func_cb();
+    }
+}
+
+uint8_t os_timer_has_deferred(void)
+{
+    return (timer_cb_queue_count != 0u) ? OS_TRUE : OS_FALSE;
+}
+#endif
+
+/* Timer task may wait for a later timer, make it compute its wait again */
+static void timer_notify_task(os_timer_t *p_timer)
+{
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    if (p_timer->hard == OS_TRUE)
+    {
+        return; /* Served by tick interrupt */
+    }
+#endif
+#if (OS_CFG_USE_TIMER_TASK == 1u)
+#if (OS_CFG_USE_TIMER_HARD == 0u)
+    (void)p_timer;
+#endif
+    os_task_post_msg_pure(REF_TASK_TIMER_ID, 0); // Dummy signal
+#else
+    (void)p_timer;
+#endif
+}
 
 void os_timer_start(os_timer_t *p_timer, uint32_t tick_to_wait)
 {
+    os_timer_start_slack(p_timer, tick_to_wait, 0u);
+}
+
+void os_timer_start_slack(os_timer_t *p_timer, uint32_t tick_to_wait, uint32_t slack)
+{
+    ENTER_CRITICAL();
     uint32_t time_now = os_task_get_tick();
 
-    list_item_set_value(&(p_timer->timer_list_item), tick_to_wait + time_now);
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+    if (p_timer->hard == OS_TRUE)
+    {
+        slack = 0u; /* Fires right on its tick */
+    }
+#endif
+    p_timer->slack = slack;
+    timer_set_expiry(p_timer, tick_to_wait + time_now);
 
     add_timer_to_list(p_timer);
     update_next_tick_to_unblock();
-    os_task_post_msg_pure(REF_TASK_TIMER_ID, 0); // Dummy signal
+    EXIT_CRITICAL();
+    timer_notify_task(p_timer);
 }
 
 void os_timer_reset(os_timer_t *p_timer)
 {
+    ENTER_CRITICAL();
     if (list_item_get_list_contain(&(p_timer->timer_list_item)) == NULL)
     {
         // OSUniversalError = OS_ERR_TIMER_IS_NOT_RUNNING;
         os_assert(0, "OS_ERR_TIMER_IS_NOT_RUNNING");
+        EXIT_CRITICAL();
         return;
     }
     uint32_t time_now = os_task_get_tick();
     os_list_remove(&(p_timer->timer_list_item));
     if (p_timer->period != 0)
     {
-        list_item_set_value(&(p_timer->timer_list_item), p_timer->period + time_now);
+        timer_set_expiry(p_timer, p_timer->period + time_now);
         add_timer_to_list(p_timer);
     }
     else
         os_timer_remove(p_timer); /* One shot */
     update_next_tick_to_unblock();
-    os_task_post_msg_pure(REF_TASK_TIMER_ID, 0); // Dummy signal
-}
\ No newline at end of file
+    EXIT_CRITICAL();
+    timer_notify_task(p_timer);
+}
+
+void os_timer_set_overrun_policy(os_timer_t *p_timer, timer_overrun_t policy)
+{
+    p_timer->overrun_policy = policy;
+}
+
+uint32_t os_timer_get_overrun(os_timer_t *p_timer)
+{
+    return p_timer->overrun_count;
+}
+
+void os_timer_get_pool_stats(pool_stats_t *p_stats)
+{
+    os_pool_get_stats(&timer_pool, p_stats);
+}
+
+uint32_t os_timer_get_wakeups_saved(void)
+{
+    return timer_wakeup_saved;
+}
+
+#if (OS_CFG_USE_TIMER_HARD == 1u)
+static void timer_hard_fire(os_timer_t *p_timer, uint32_t time_now)
+{
+    uint32_t late = ((time_now - p_timer->expiry) * (OS_CPU_CORE_CLOCK / 1000u)) + os_cpu_tick_elapsed_counts();
+
+    if (late < p_timer->late_min)
+        p_timer->late_min = late;
+    if (late > p_timer->late_max)
+        p_timer->late_max = late;
+    p_timer->late_sum += late;
+    p_timer->late_count++;
+
+    timer_hard_cb_running = OS_TRUE;
+    p_timer->func_cb();
+    timer_hard_cb_running = OS_FALSE;
+}
+
+void os_timer_hard_processing(void)
+{
+    os_timer_t *p_timer;
+    list_t *p_due_list;
+    const uint32_t time_now = os_task_get_tick();
+
+    while (timer_hard_wheel.time != time_now)
+    {
+        if ((time_now - timer_hard_wheel.time) > 1u)
+        {
+            /* Tick was stepped (tickless), jump over ticks with nothing to do */
+            os_wheel_skip(&timer_hard_wheel, time_now - timer_hard_wheel.time - 1u);
+        }
+        p_due_list = os_wheel_tick(&timer_hard_wheel);
+        while (list_is_empty(p_due_list) == OS_FALSE)
+        {
+            p_timer = list_get_owner_of_head_item(p_due_list);
+            os_list_remove(&(p_timer->timer_list_item));
+
+            timer_hard_fire(p_timer, time_now);
+            if (p_timer->period != 0)
+            {
+                /* Never late by a period, wheel is moved on every tick */
+                timer_set_expiry(p_timer, p_timer->expiry + p_timer->period);
+                os_wheel_insert(&timer_hard_wheel, &(p_timer->timer_list_item));
+            }
+            else
+                os_timer_remove(p_timer); /* One shot */
+        }
+    }
+}
+
+uint32_t os_timer_hard_get_next_delta(void)
+{
+    return os_wheel_get_next_delta(&timer_hard_wheel);
+}
+
+uint8_t os_timer_in_hard_cb(void)
+{
+    return timer_hard_cb_running;
+}
+
+void os_timer_get_jitter(os_timer_t *p_timer, timer_jitter_t *p_jitter)
+{
+    ENTER_CRITICAL();
+    p_jitter->count = p_timer->late_count;
+    p_jitter->min = (p_timer->late_count != 0u) ? p_timer->late_min : 0u;
+    p_jitter->max = p_timer->late_max;
+    p_jitter->avg = (p_timer->late_count != 0u) ? (uint32_t)(p_timer->late_sum / p_timer->late_count) : 0u;
+    EXIT_CRITICAL();
+}
+#endif
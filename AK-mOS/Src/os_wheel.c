@@ -0,0 +1,120 @@
+#include "os_wheel.h"
+#include "os_kernel.h"
+
+static void wheel_place(wheel_t *p_wheel, list_item_t *p_item, uint32_t delta)
+{
+    uint8_t level = 0u;
+    uint32_t shift = 0u;
+
+    if (delta >= OS_WHEEL_RANGE)
+    {
+        /* Out of range, park it in top level. It is placed again on cascade with real value */
+        delta = OS_WHEEL_RANGE - 1u;
+    }
+    while (delta >= (OS_WHEEL_SLOTS << shift))
+    {
+        level++;
+        shift += OS_CFG_WHEEL_SLOT_BITS;
+    }
+    os_list_insert_end(&(p_wheel->slot[level][((p_wheel->time + delta) >> shift) & OS_WHEEL_MASK]), p_item);
+}
+
+void os_wheel_init(wheel_t *p_wheel, uint32_t time_now)
+{
+    uint8_t level;
+    uint32_t idx;
+    for (level = 0u; level < OS_CFG_WHEEL_LEVELS; level++)
+    {
+        for (idx = 0u; idx < OS_WHEEL_SLOTS; idx++)
+        {
+            os_list_init(&(p_wheel->slot[level][idx]));
+        }
+    }
+    p_wheel->time = time_now;
+}
+
+void os_wheel_insert(wheel_t *p_wheel, list_item_t *p_item)
+{
+    uint32_t delta = list_item_get_value(p_item) - p_wheel->time;
+
+    /* Slot of current tick is already processed, so earliest is next tick (as sorted list does) */
+    if (delta == 0u)
+    {
+        delta = 1u;
+    }
+    wheel_place(p_wheel, p_item, delta);
+}
+
+list_t *os_wheel_tick(wheel_t *p_wheel)
+{
+    list_t *p_slot;
+    list_item_t *p_item;
+    uint8_t level;
+    uint32_t shift = OS_CFG_WHEEL_SLOT_BITS;
+    const uint32_t time = p_wheel->time + 1u;
+
+    p_wheel->time = time;
+
+    /* Cascade every level whose lower levels just wrapped */
+    for (level = 1u; level < OS_CFG_WHEEL_LEVELS; level++)
+    {
+        if ((time & ((1u << shift) - 1u)) != 0u)
+        {
+            break;
+        }
+        p_slot = &(p_wheel->slot[level][(time >> shift) & OS_WHEEL_MASK]);
+        while (list_is_empty(p_slot) == OS_FALSE)
+        {
+            p_item = list_get_head_item(p_slot);
+            os_list_remove(p_item);
+            /* Delta 0 lands in slot of current tick, which is returned below */
+            wheel_place(p_wheel, p_item, list_item_get_value(p_item) - time);
+        }
+        shift += OS_CFG_WHEEL_SLOT_BITS;
+    }
+
+    return &(p_wheel->slot[0][time & OS_WHEEL_MASK]);
+}
+
+uint32_t os_wheel_get_next_delta(wheel_t *p_wheel)
+{
+    uint32_t next = OS_CFG_DELAY_MAX;
+    uint32_t delta;
+    uint32_t offset;
+    uint32_t idx;
+    uint32_t shift = 0u;
+    uint8_t level;
+    const uint32_t time = p_wheel->time;
+
+    for (level = 0u; level < OS_CFG_WHEEL_LEVELS; level++)
+    {
+        for (offset = 1u; offset <= OS_WHEEL_SLOTS; offset++)
+        {
+            idx = ((time >> shift) + offset) & OS_WHEEL_MASK;
+            if (list_is_empty(&(p_wheel->slot[level][idx])) == OS_FALSE)
+            {
+                /* Level 0 expires at that tick, upper levels cascade at start of that slot */
+                delta = (offset << shift) - (time & ((1u << shift) - 1u));
+                if (delta < next)
+                {
+                    next = delta;
+                }
+                break;
+            }
+        }
+        shift += OS_CFG_WHEEL_SLOT_BITS;
+    }
+    return next;
+}
+
+uint32_t os_wheel_skip(wheel_t *p_wheel, uint32_t max_ticks)
+{
+    uint32_t skip = os_wheel_get_next_delta(p_wheel) - 1u;
+
+    if (skip > max_ticks)
+    {
+        skip = max_ticks;
+    }
+    p_wheel->time += skip;
+    return skip;
+}
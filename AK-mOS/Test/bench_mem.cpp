@@ -0,0 +1,227 @@
+/* Allocator benchmark (first fit vs TLSF), run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -I.. -I../Inc bench_mem.cpp plus every file in ../Src
+ * (Src files built as C, system.h from app), OS_CFG_HEAP_SIZE set to ((size_t)1024 * 32u).
+ * Build once with OS_CFG_USE_MEM_TLSF (0u) and once with (1u), compare the printed latency (avg, p99, max) and fragmentation.
+ * Fragmentation probe ends on a failed malloc, one OS_ERR_MEM_NO_BLOCK assert print per profile is expected.
+ * Exit code 0 is pass (os_mem_check and byte count hold after every randomized run).
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_OPS           (20000u)
+#define BENCH_CHECK_EVERY   (500u)
+#define BENCH_MAX_SLOTS     (256u)
+#define BENCH_PROBE_SIZE    (256u)
+#define BENCH_MAX_PROBES    (256u)
+
+static_assert(OS_CFG_HEAP_SIZE >= 1024 * 32u, "bench_mem needs OS_CFG_HEAP_SIZE of ((size_t)1024 * 32u)");
+
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+};
+
+typedef struct
+{
+    const char *name;
+    uint32_t slots;     /* Max live blocks */
+    uint32_t size_min;
+    uint32_t size_max;
+} bench_profile_t;
+
+static void *slots[BENCH_MAX_SLOTS];
+static void *probes[BENCH_MAX_PROBES];
+static uint32_t malloc_samples[BENCH_OPS];
+static uint32_t free_samples[BENCH_OPS];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int sample_cmp(const void *p_a, const void *p_b)
+{
+    uint32_t a = *(const uint32_t *)p_a;
+    uint32_t b = *(const uint32_t *)p_b;
+    return (a > b) - (a < b);
+}
+
+/* 99th percentile, host jitter makes max alone meaningless */
+static uint32_t sample_p99(uint32_t *p_samples, uint32_t cnt)
+{
+    if (cnt == 0u)
+    {
+        return 0u;
+    }
+    qsort(p_samples, cnt, sizeof(uint32_t), sample_cmp);
+    return p_samples[(cnt * 99u) / 100u];
+}
+
+/* Touch whole free heap once so page faults of host do not show up as max latency */
+static void bench_warm_up(void)
+{
+    size_t size = os_mem_get_byte_available();
+    void *p_all = os_mem_malloc(size);
+    if (p_all != NULL)
+    {
+        memset(p_all, 0, size);
+        os_mem_free(p_all);
+    }
+}
+
+/* Randomized malloc/free on one profile, returns OS_FALSE if heap check fails */
+static uint8_t bench_run(const bench_profile_t *p_prof)
+{
+    uint64_t malloc_ns = 0u, malloc_max = 0u, free_ns = 0u, free_max = 0u;
+    uint32_t malloc_cnt = 0u, free_cnt = 0u, fail_cnt = 0u, probe_cnt = 0u;
+    uint32_t avail_start = os_mem_get_byte_available();
+    uint32_t avail_live;
+    uint8_t is_pass = OS_TRUE;
+    uint32_t idx;
+
+    for (idx = 0u; idx < BENCH_OPS; idx++)
+    {
+        uint32_t slot = (uint32_t)rand() % p_prof->slots;
+        uint64_t t0, dt;
+        if (slots[slot] == NULL)
+        {
+            size_t size = p_prof->size_min + ((uint32_t)rand() % (p_prof->size_max - p_prof->size_min + 1u));
+            ENTER_CRITICAL();
+            t0 = now_ns();
+            slots[slot] = os_mem_malloc(size);
+            dt = now_ns() - t0;
+            EXIT_CRITICAL();
+            if (slots[slot] == NULL)
+            {
+                fail_cnt++;
+                continue;
+            }
+            malloc_ns += dt;
+            malloc_max = (dt > malloc_max) ? dt : malloc_max;
+            malloc_samples[malloc_cnt++] = (uint32_t)dt;
+        }
+        else
+        {
+            ENTER_CRITICAL();
+            t0 = now_ns();
+            os_mem_free(slots[slot]);
+            dt = now_ns() - t0;
+            EXIT_CRITICAL();
+            slots[slot] = NULL;
+            free_ns += dt;
+            free_max = (dt > free_max) ? dt : free_max;
+            free_samples[free_cnt++] = (uint32_t)dt;
+        }
+        if ((idx % BENCH_CHECK_EVERY) == 0u && os_mem_check() != OS_TRUE)
+        {
+            is_pass = OS_FALSE;
+        }
+    }
+
+    /* Fragmentation: share of free bytes still reachable as BENCH_PROBE_SIZE blocks */
+    avail_live = os_mem_get_byte_available();
+    while (probe_cnt < BENCH_MAX_PROBES)
+    {
+        probes[probe_cnt] = os_mem_malloc(BENCH_PROBE_SIZE);
+        if (probes[probe_cnt] == NULL)
+        {
+            break;
+        }
+        probe_cnt++;
+    }
+    for (idx = 0u; idx < probe_cnt; idx++)
+    {
+        os_mem_free(probes[idx]);
+    }
+    for (idx = 0u; idx < p_prof->slots; idx++)
+    {
+        if (slots[idx] != NULL)
+        {
+            os_mem_free(slots[idx]);
+            slots[idx] = NULL;
+        }
+    }
+    if (os_mem_check() != OS_TRUE || os_mem_get_byte_available() != avail_start)
+    {
+        is_pass = OS_FALSE;
+    }
+
+    ENTER_CRITICAL();
+    printf("%-6s %7llu %7u %7llu %7llu %7u %7llu %6u %8u %5u%%  %s\n", p_prof->name,
+           (unsigned long long)(malloc_ns / (malloc_cnt ? malloc_cnt : 1u)), (unsigned)sample_p99(malloc_samples, malloc_cnt),
+           (unsigned long long)malloc_max,
+           (unsigned long long)(free_ns / (free_cnt ? free_cnt : 1u)), (unsigned)sample_p99(free_samples, free_cnt),
+           (unsigned long long)free_max,
+           (unsigned)fail_cnt, (unsigned)avail_live,
+           (unsigned)(100u - (probe_cnt * BENCH_PROBE_SIZE * 100u) / avail_live),
+           (is_pass == OS_TRUE) ? "ok" : "HEAP CHECK FAILED");
+    EXIT_CRITICAL();
+    return is_pass;
+}
+
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    static const bench_profile_t profiles[] = {
+        {"small", 256u, 8u, 64u},
+        {"mixed", 48u, 8u, 400u},
+        {"large", 16u, 256u, 1500u},
+    };
+    uint8_t is_pass = OS_TRUE;
+    uint32_t idx;
+
+    srand(1u);
+    bench_warm_up();
+    ENTER_CRITICAL();
+    printf("mem bench (%s), ns per op, %u ops per profile\n", (OS_CFG_USE_MEM_TLSF == 1u) ? "tlsf" : "first fit", (unsigned)BENCH_OPS);
+    printf("%-6s %7s %7s %7s %7s %7s %7s %6s %8s %6s\n", "prof", "malloc", "p99", "max", "free", "p99", "max", "fails", "free_B", "frag");
+    EXIT_CRITICAL();
+    for (idx = 0u; idx < sizeof(profiles) / sizeof(profiles[0]); idx++)
+    {
+        if (bench_run(&profiles[idx]) != OS_TRUE)
+        {
+            is_pass = OS_FALSE;
+        }
+    }
+    ENTER_CRITICAL();
+    printf("%s\n", (is_pass == OS_TRUE) ? "PASS" : "FAIL");
+    EXIT_CRITICAL();
+    exit((is_pass == OS_TRUE) ? 0 : 1);
+}
+
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+int main()
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 0;
+}
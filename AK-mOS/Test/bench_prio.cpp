@@ -0,0 +1,204 @@
+/* Priority lookup benchmark (old byte table scan vs word bitmap with CLZ), run on Linux host:
+ * g++ -O2 -I.. -I../Inc bench_prio.cpp ../Src/os_prio.c (os_prio.c built as C, system.h from app)
+ * with OS_CFG_PRIO_MAX set to (256). Old lookup is kept here as reference, kernel is not started.
+ * Build once with OS_CFG_PRIO_SOFT_CLZ (0u) and once with (1u): every lookup must match the old one
+ * and the printed lookup sum must be the same for both builds, so builtin CLZ and portable fallback agree.
+ * Exit code 0 is pass.
+ */
+#include "os_kernel.h"
+#include "os_prio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_SETS          (1024u)
+#define BENCH_LOOKUPS       (256u)      /* Per set */
+#define BENCH_READY_MAX     (4u)        /* Ready prios per set besides idle */
+#define BENCH_DENSE_SETS    (4096u)
+
+static_assert(OS_CFG_PRIO_MAX == 256, "bench_prio needs OS_CFG_PRIO_MAX of (256)");
+
+/* Lookup before word bitmap: byte rows scanned from prio 0 */
+static uint8_t old_tbl[OS_CFG_PRIO_MAX / 8u];
+
+static void old_insert(uint32_t prio)
+{
+    old_tbl[prio / 8u] |= (uint8_t)1u << (7u - (prio & 7u));
+}
+
+static void old_remove(uint32_t prio)
+{
+    old_tbl[prio / 8u] &= ~((uint8_t)1u << (7u - (prio & 7u)));
+}
+
+__attribute__((noipa)) static uint32_t old_get_highest(void)
+{
+    uint8_t *p_tbl = &old_tbl[0];
+    uint32_t prio = 0u;
+    while (*p_tbl == 0u)
+    {
+        prio += 8u;
+        p_tbl++;
+    }
+    uint8_t bit = (uint8_t)prio & 7u;
+    while (!(*p_tbl & ((uint8_t)1u << (7u - bit))))
+    {
+        prio++;
+        bit = (uint8_t)prio & 7u;
+    }
+    return prio;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t time_new(uint64_t *p_ns)
+{
+    uint32_t sum = 0u;
+    uint32_t idx;
+    uint64_t t0 = now_ns();
+    for (idx = 0u; idx < BENCH_LOOKUPS; idx++)
+    {
+        sum += os_prio_get_highest();
+        __asm__ volatile("" ::: "memory");
+    }
+    *p_ns += now_ns() - t0;
+    return sum;
+}
+
+static uint32_t time_old(uint64_t *p_ns)
+{
+    uint32_t sum = 0u;
+    uint32_t idx;
+    uint64_t t0 = now_ns();
+    for (idx = 0u; idx < BENCH_LOOKUPS; idx++)
+    {
+        sum += old_get_highest();
+        __asm__ volatile("" ::: "memory");
+    }
+    *p_ns += now_ns() - t0;
+    return sum;
+}
+
+/* A few ready tasks below prio_cnt, idle at prio_cnt - 1 as with OS_CFG_PRIO_MAX = prio_cnt */
+static uint8_t bench_count(uint32_t prio_cnt, uint32_t *p_sum)
+{
+    uint64_t ns_new = 0u, ns_old = 0u, ns_new_idle = 0u, ns_old_idle = 0u;
+    uint32_t ready[BENCH_READY_MAX];
+    uint8_t is_pass = OS_TRUE;
+    uint32_t set, idx;
+
+    os_prio_insert(prio_cnt - 1u);
+    old_insert(prio_cnt - 1u);
+    for (set = 0u; set < BENCH_SETS; set++)
+    {
+        uint32_t ready_cnt = (uint32_t)rand() % (BENCH_READY_MAX + 1u);
+        for (idx = 0u; idx < ready_cnt; idx++)
+        {
+            ready[idx] = (uint32_t)rand() % (prio_cnt - 1u);
+            os_prio_insert(ready[idx]);
+            old_insert(ready[idx]);
+        }
+        if (os_prio_get_highest() != old_get_highest())
+        {
+            is_pass = OS_FALSE;
+        }
+        *p_sum += time_new(&ns_new);
+        time_old(&ns_old);
+        for (idx = 0u; idx < ready_cnt; idx++)
+        {
+            os_prio_remove(ready[idx]);
+            old_remove(ready[idx]);
+        }
+    }
+    /* Only idle ready, the old scan walks every row */
+    for (set = 0u; set < BENCH_SETS; set++)
+    {
+        time_new(&ns_new_idle);
+        time_old(&ns_old_idle);
+    }
+    if (prio_cnt != OS_CFG_PRIO_MAX)
+    {
+        os_prio_remove(prio_cnt - 1u);
+        old_remove(prio_cnt - 1u);
+    }
+
+    printf("%6u %9.2f %9.2f %9.2f %9.2f\n", (unsigned)prio_cnt,
+           (double)ns_old / (BENCH_SETS * BENCH_LOOKUPS), (double)ns_new / (BENCH_SETS * BENCH_LOOKUPS),
+           (double)ns_old_idle / (BENCH_SETS * BENCH_LOOKUPS), (double)ns_new_idle / (BENCH_SETS * BENCH_LOOKUPS));
+    return is_pass;
+}
+
+/* Random bits over all 256 prios, every row and every bit position gets a turn */
+static uint8_t bench_dense(uint32_t *p_sum)
+{
+    uint8_t is_pass = OS_TRUE;
+    uint32_t set, prio;
+
+    for (set = 0u; set < BENCH_DENSE_SETS; set++)
+    {
+        uint32_t density = 1u + ((uint32_t)rand() % 64u); /* 1/density of prios ready */
+        for (prio = 0u; prio < OS_CFG_PRIO_MAX - 1u; prio++)
+        {
+            if (((uint32_t)rand() % density) == 0u)
+            {
+                os_prio_insert(prio);
+                old_insert(prio);
+            }
+        }
+        while (1)
+        {
+            uint32_t highest = os_prio_get_highest();
+            if (highest != old_get_highest())
+            {
+                is_pass = OS_FALSE;
+                break;
+            }
+            *p_sum += highest;
+            if (highest == OS_CFG_PRIO_MAX - 1u)
+            {
+                break;
+            }
+            /* Peel off highest, next lookup finds the one below */
+            os_prio_remove(highest);
+            old_remove(highest);
+        }
+        for (prio = 0u; prio < OS_CFG_PRIO_MAX - 1u; prio++)
+        {
+            os_prio_remove(prio);
+            old_remove(prio);
+        }
+    }
+    return is_pass;
+}
+
+int main()
+{
+    static const uint32_t prio_cnts[] = {8u, 10u, 32u, 64u, 128u, 256u};
+    uint8_t is_pass = OS_TRUE;
+    uint32_t sum = 0u;
+    uint32_t idx;
+
+    srand(1u);
+    os_prio_init();
+    old_insert(OS_CFG_PRIO_MAX - 1u);
+    printf("prio bench (%s), ns per lookup\n", (OS_CFG_PRIO_SOFT_CLZ == 1u) ? "portable clz" : "builtin clz");
+    printf("%6s %9s %9s %9s %9s\n", "prios", "old", "new", "old_idle", "new_idle");
+    for (idx = 0u; idx < sizeof(prio_cnts) / sizeof(prio_cnts[0]); idx++)
+    {
+        if (bench_count(prio_cnts[idx], &sum) != OS_TRUE)
+        {
+            is_pass = OS_FALSE;
+        }
+    }
+    if (bench_dense(&sum) != OS_TRUE)
+    {
+        is_pass = OS_FALSE;
+    }
+    printf("lookup sum %08x, %s\n", (unsigned)sum, (is_pass == OS_TRUE) ? "PASS" : "FAIL: lookup differs from old");
+    return (is_pass == OS_TRUE) ? 0 : 1;
+}
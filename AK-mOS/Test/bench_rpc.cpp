@@ -0,0 +1,125 @@
+/* RPC round trip benchmark (os_task_call vs post and wait for reply msg), run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -I.. -I../Inc bench_rpc.cpp plus every file in ../Src
+ * (Src files built as C, system.h from app), OS_CFG_USE_MSG_RPC set to (1u).
+ * Both ways carry a 4 byte request and a 4 byte reply between two tasks of equal prio.
+ * Exit code 0 is pass (every reply right, no msg left in pool).
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (OS_CFG_USE_MSG_RPC == 0u)
+#error "bench_rpc needs OS_CFG_USE_MSG_RPC (1u)"
+#endif
+
+#define BENCH_ROUND_TRIPS   (20000u)
+#define SIG_CALL            (1)
+#define SIG_REQ             (2)
+#define SIG_RSP             (3)
+
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Client */
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    uint32_t bad = 0u;
+    uint32_t req, rsp;
+    uint16_t len;
+    uint64_t t0, ns_call, ns_post;
+    pool_stats_t stats;
+
+    t0 = now_ns();
+    for (req = 0u; req < BENCH_ROUND_TRIPS; req++)
+    {
+        len = sizeof(rsp);
+        if (os_task_call(TASK_2_ID, SIG_CALL, &req, sizeof(req), &rsp, &len, OS_CFG_DELAY_MAX) != OS_TRUE ||
+            rsp != req + 1u)
+        {
+            bad++;
+        }
+    }
+    ns_call = now_ns() - t0;
+
+    t0 = now_ns();
+    for (req = 0u; req < BENCH_ROUND_TRIPS; req++)
+    {
+        msg_t *p_msg;
+        os_task_post_msg_dynamic(TASK_2_ID, SIG_REQ, &req, sizeof(req));
+        p_msg = os_task_wait_for_msg(OS_CFG_DELAY_MAX);
+        memcpy(&rsp, os_msg_get_data(p_msg, &len), sizeof(rsp));
+        if (p_msg->sig != SIG_RSP || rsp != req + 1u)
+        {
+            bad++;
+        }
+        os_msg_free(p_msg);
+    }
+    ns_post = now_ns() - t0;
+
+    os_msg_get_pool_stats(&stats);
+    ENTER_CRITICAL();
+    printf("rpc bench, %u round trips, 4 byte request and reply\n", (unsigned)BENCH_ROUND_TRIPS);
+    printf("os_task_call         %7.2f us per round trip\n", (double)ns_call / BENCH_ROUND_TRIPS / 1000.0);
+    printf("post + wait for msg  %7.2f us per round trip\n", (double)ns_post / BENCH_ROUND_TRIPS / 1000.0);
+    printf("%s\n", (bad == 0u && stats.used == 0u) ? "PASS" : "FAIL");
+    EXIT_CRITICAL();
+    exit((bad == 0u && stats.used == 0u) ? 0 : 1);
+}
+
+/* Server, adds 1 */
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        msg_t *p_msg = os_task_wait_for_msg(OS_CFG_DELAY_MAX);
+        uint16_t len;
+        uint32_t val;
+        memcpy(&val, os_msg_get_data(p_msg, &len), sizeof(val));
+        val++;
+        if (p_msg->sig == SIG_CALL)
+        {
+            os_task_reply(p_msg, &val, sizeof(val));
+        }
+        else
+        {
+            os_task_post_msg_dynamic(TASK_1_ID, SIG_RSP, &val, sizeof(val));
+        }
+        os_msg_free(p_msg);
+    }
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+int main()
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 0;
+}
@@ -0,0 +1,227 @@
+/* Timer backend benchmark (sorted lists vs timing wheel), run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -I.. -I../Inc bench_timer.cpp plus every file in ../Src
+ * (Src files built as C, system.h from app), OS_CFG_TIMER_POOL_SIZE set to (1024u).
+ * Build once with OS_CFG_USE_TIMER_WHEEL (0u) and once with (1u), compare the printed ns per op.
+ * Start/reset/stop ops run in batches inside one critical section, timer task then drains its queue.
+ * Exit code 0 is pass.
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "os_timer.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_BATCH         (6u)        /* Below timer task queue size, one notify msg per op */
+#define BENCH_RESET_OPS     (2046u)     /* Multiple of BENCH_BATCH */
+#define BENCH_PERIOD_MIN    (100000u)   /* Nothing expires while start/reset/stop are measured */
+#define BENCH_EXPIRE_AFTER  (20u)
+#define BENCH_EXPIRE_PERIOD (1000u)
+#define BENCH_MAX_TIMERS    (1024u)
+
+#if (OS_CFG_TIMER_POOL_SIZE < BENCH_MAX_TIMERS)
+#error "bench_timer needs OS_CFG_TIMER_POOL_SIZE of 1024u"
+#endif
+
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+};
+
+static os_timer_t *timers[BENCH_MAX_TIMERS];
+static volatile uint32_t expire_count;
+static uint64_t expire_first_ns;
+static uint64_t expire_last_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void idle_cb(void)
+{
+}
+
+static void expire_cb(void)
+{
+    uint64_t ns = now_ns();
+    if (expire_count == 0u)
+    {
+        expire_first_ns = ns;
+    }
+    expire_last_ns = ns;
+    expire_count++;
+}
+
+static uint32_t rand_period(void)
+{
+    return BENCH_PERIOD_MIN + ((uint32_t)rand() % BENCH_PERIOD_MIN);
+}
+
+/* Start n timers at random expiry, ns per start over the fill 0 -> n */
+static uint64_t bench_start(uint32_t n)
+{
+    uint64_t total = 0u;
+    uint32_t idx;
+    for (idx = 0u; idx < n; idx++)
+    {
+        timers[idx] = os_timer_create((timer_id_t)idx, 0, idle_cb, TASK_2_ID, rand_period(), TIMER_PERIODIC);
+    }
+    for (idx = 0u; idx < n; idx += BENCH_BATCH)
+    {
+        uint32_t end = (idx + BENCH_BATCH < n) ? (idx + BENCH_BATCH) : n;
+        uint32_t i;
+        ENTER_CRITICAL();
+        uint64_t t0 = now_ns();
+        for (i = idx; i < end; i++)
+        {
+            os_timer_start(timers[i], timers[i]->period);
+        }
+        total += now_ns() - t0;
+        EXIT_CRITICAL();
+    }
+    return total / n;
+}
+
+/* Reset random running timers, n timers running */
+static uint64_t bench_reset(uint32_t n)
+{
+    uint64_t total = 0u;
+    uint32_t idx;
+    for (idx = 0u; idx < BENCH_RESET_OPS; idx += BENCH_BATCH)
+    {
+        uint32_t i;
+        ENTER_CRITICAL();
+        uint64_t t0 = now_ns();
+        for (i = 0u; i < BENCH_BATCH; i++)
+        {
+            os_timer_reset(timers[(uint32_t)rand() % n]);
+        }
+        total += now_ns() - t0;
+        EXIT_CRITICAL();
+    }
+    return total / BENCH_RESET_OPS;
+}
+
+/* Stop every running timer, ns per stop */
+static uint64_t bench_stop(uint32_t n)
+{
+    uint64_t total = 0u;
+    uint32_t idx;
+    for (idx = 0u; idx < n; idx += BENCH_BATCH)
+    {
+        uint32_t end = (idx + BENCH_BATCH < n) ? (idx + BENCH_BATCH) : n;
+        uint32_t i;
+        ENTER_CRITICAL();
+        uint64_t t0 = now_ns();
+        for (i = idx; i < end; i++)
+        {
+            os_timer_remove(timers[i]);
+        }
+        total += now_ns() - t0;
+        EXIT_CRITICAL();
+    }
+    return total / n;
+}
+
+/* n periodic timers due on the same tick, ns per expiry incl. callback and re-arm */
+static uint64_t bench_expire(uint32_t n)
+{
+    uint32_t idx;
+    uint32_t tick_due = os_task_get_tick() + BENCH_EXPIRE_AFTER;
+    expire_count = 0u;
+    for (idx = 0u; idx < n; idx++)
+    {
+        timers[idx] = os_timer_create((timer_id_t)idx, 0, expire_cb, TASK_2_ID, BENCH_EXPIRE_PERIOD, TIMER_PERIODIC);
+    }
+    ENTER_CRITICAL();
+    for (idx = 0u; idx < n; idx += BENCH_BATCH)
+    {
+        uint32_t end = (idx + BENCH_BATCH < n) ? (idx + BENCH_BATCH) : n;
+        uint32_t i;
+        for (i = idx; i < end; i++)
+        {
+            os_timer_start(timers[i], tick_due - os_task_get_tick()); /* Starts may span ticks */
+        }
+        EXIT_CRITICAL(); /* Let timer task drain notify msgs, all due on the same tick */
+        ENTER_CRITICAL();
+    }
+    EXIT_CRITICAL();
+    os_task_delay(BENCH_EXPIRE_AFTER * 2u);
+    for (idx = 0u; idx < n; idx++)
+    {
+        os_timer_remove(timers[idx]);
+    }
+    if (expire_count != n)
+    {
+        return 0u;
+    }
+    return (n > 1u) ? (expire_last_ns - expire_first_ns) / (n - 1u) : 0u;
+}
+
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    static const uint32_t sizes[] = {8u, 64u, 256u, 1024u};
+    uint8_t is_pass = OS_TRUE;
+    uint32_t idx;
+
+    srand(1u);
+    ENTER_CRITICAL();
+    printf("timer bench (%s), ns per op\n", (OS_CFG_USE_TIMER_WHEEL == 1u) ? "wheel" : "lists");
+    printf("%8s %8s %8s %8s %8s\n", "timers", "start", "reset", "stop", "expire");
+    EXIT_CRITICAL();
+    for (idx = 0u; idx < sizeof(sizes) / sizeof(sizes[0]); idx++)
+    {
+        uint32_t n = sizes[idx];
+        uint64_t ns_start = bench_start(n);
+        uint64_t ns_reset = bench_reset(n);
+        uint64_t ns_stop = bench_stop(n);
+        uint64_t ns_expire = bench_expire(n);
+        if (ns_expire == 0u)
+        {
+            is_pass = OS_FALSE;
+        }
+        ENTER_CRITICAL();
+        printf("%8u %8llu %8llu %8llu %8llu\n", (unsigned)n, (unsigned long long)ns_start,
+               (unsigned long long)ns_reset, (unsigned long long)ns_stop, (unsigned long long)ns_expire);
+        EXIT_CRITICAL();
+    }
+    ENTER_CRITICAL();
+    printf("%s\n", (is_pass == OS_TRUE) ? "PASS" : "FAIL: missed expiries");
+    EXIT_CRITICAL();
+    exit((is_pass == OS_TRUE) ? 0 : 1);
+}
+
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+int main()
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 0;
+}
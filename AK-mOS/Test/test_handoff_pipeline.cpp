@@ -0,0 +1,181 @@
+/* Handoff test, 4 stage pipeline at equal prio, run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -Ipipeline -I.. -I../Inc test_handoff_pipeline.cpp plus every file in ../Src
+ * (Src files built as C with the same include order, so pipeline/task_list.h gives 4 app tasks; system.h from app),
+ * OS_CFG_USE_TASK_HANDOFF set to (1u). Each stage keeps working after its post, as a real stage would.
+ * Per hop latency is printed with handoff off, per task (os_task_set_handoff) and per post (os_task_handoff).
+ * Exit code 0 is pass (every item through all stages in order, handoff faster than no handoff).
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if (OS_CFG_USE_TASK_HANDOFF == 0u)
+#error "test_handoff_pipeline needs OS_CFG_USE_TASK_HANDOFF (1u)"
+#endif
+
+#define TEST_ITEMS          (200u)      /* Per mode */
+#define TEST_WORK_NS        (300000u)   /* Work of a stage after its post */
+#define TEST_STAGES         (4u)
+
+typedef enum
+{
+    HANDOFF_OFF = 0,
+    HANDOFF_PER_TASK,
+    HANDOFF_PER_POST,
+    HANDOFF_MODE_NUM
+} handoff_mode_t;
+
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   1,      8,              64,         MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   1,      8,              64,         MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   1,      8,              64,         MSG_Q_OVERFLOW_ASSERT},
+    {TASK_4_ID,     task_4,     NULL,   1,      8,              64,         MSG_Q_OVERFLOW_ASSERT},
+};
+
+static volatile handoff_mode_t mode;
+static volatile uint64_t sent_ns[TEST_STAGES];
+static uint64_t hop_sum_ns[HANDOFF_MODE_NUM];
+static uint64_t hop_max_ns[HANDOFF_MODE_NUM];
+static uint32_t hop_cnt[HANDOFF_MODE_NUM];
+static volatile uint32_t last_done;
+static volatile uint32_t out_of_order;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void stage_work(void)
+{
+    uint64_t t0 = now_ns();
+    while (now_ns() - t0 < TEST_WORK_NS)
+    {
+    }
+}
+
+static void stage_post(uint8_t next_id, int32_t sig)
+{
+    sent_ns[next_id] = now_ns();
+    os_task_post_msg_pure(next_id, sig);
+    if (mode == HANDOFF_PER_POST)
+    {
+        os_task_handoff(next_id);
+    }
+}
+
+static void stage_hop(uint8_t self_id)
+{
+    uint64_t dt = now_ns() - sent_ns[self_id];
+    hop_sum_ns[mode] += dt;
+    hop_max_ns[mode] = (dt > hop_max_ns[mode]) ? dt : hop_max_ns[mode];
+    hop_cnt[mode]++;
+}
+
+/* Stage 2..4: take item, pass it on, keep working */
+static void stage_run(uint8_t self_id)
+{
+    for (;;)
+    {
+        msg_t *p_msg = os_task_wait_for_msg(OS_CFG_DELAY_MAX);
+        int32_t sig = p_msg->sig;
+        stage_hop(self_id);
+        os_msg_free(p_msg);
+        if (self_id + 1u < TEST_STAGES)
+        {
+            stage_post(self_id + 1u, sig);
+        }
+        else
+        {
+            if ((uint32_t)sig != last_done + 1u)
+            {
+                out_of_order++;
+            }
+            last_done = (uint32_t)sig;
+        }
+        stage_work();
+    }
+}
+
+/* Producer, also the checker */
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    static const char *mode_name[HANDOFF_MODE_NUM] = {"off", "per task", "per post"};
+    uint32_t seq = 0u;
+    uint8_t is_pass;
+    uint32_t idx;
+
+    for (idx = 0u; idx < HANDOFF_MODE_NUM; idx++)
+    {
+        uint32_t item;
+        uint8_t id;
+        mode = (handoff_mode_t)idx;
+        for (id = TASK_2_ID; id <= TASK_4_ID; id++)
+        {
+            os_task_set_handoff(id, (mode == HANDOFF_PER_TASK) ? 1u : 0u);
+        }
+        for (item = 0u; item < TEST_ITEMS; item++)
+        {
+            os_task_delay(2u);
+            seq++;
+            stage_post(TASK_2_ID, (int32_t)seq);
+            stage_work();
+        }
+        os_task_delay(5u); /* Drain pipeline before next mode */
+    }
+
+    is_pass = (last_done == seq && out_of_order == 0u) ? OS_TRUE : OS_FALSE;
+    ENTER_CRITICAL();
+    printf("%u stages, %u items per mode, %u us of work after each post\n",
+           (unsigned)TEST_STAGES, (unsigned)TEST_ITEMS, (unsigned)(TEST_WORK_NS / 1000u));
+    for (idx = 0u; idx < HANDOFF_MODE_NUM; idx++)
+    {
+        printf("handoff %-8s hops %4u  per hop avg %8.1f us  max %8.1f us\n", mode_name[idx], (unsigned)hop_cnt[idx],
+               (double)hop_sum_ns[idx] / (hop_cnt[idx] ? hop_cnt[idx] : 1u) / 1000.0, (double)hop_max_ns[idx] / 1000.0);
+        if (hop_cnt[idx] != TEST_ITEMS * (TEST_STAGES - 1u))
+        {
+            is_pass = OS_FALSE;
+        }
+        if (idx != HANDOFF_OFF && hop_sum_ns[idx] >= hop_sum_ns[HANDOFF_OFF])
+        {
+            is_pass = OS_FALSE;
+        }
+    }
+    printf("%s\n", (is_pass == OS_TRUE) ? "PASS" : "FAIL");
+    EXIT_CRITICAL();
+    exit((is_pass == OS_TRUE) ? 0 : 1);
+}
+
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    stage_run(TASK_2_ID);
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    stage_run(TASK_3_ID);
+}
+
+void task_4(void *p_arg)
+{
+    (void)p_arg;
+    stage_run(TASK_4_ID);
+}
+
+int main()
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 0;
+}
@@ -0,0 +1,154 @@
+/* RPC test (os_task_call/os_task_reply), run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -I.. -I../Inc test_rpc.cpp plus every file in ../Src
+ * (Src files built as C, system.h from app), OS_CFG_USE_MSG_RPC set to (1u).
+ * Checks reply cut to caller buffer, and late replies: to a caller back to idle and to a caller
+ * already waiting on its next call (stale call_seq). Exit code 0 is pass.
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (OS_CFG_USE_MSG_RPC == 0u)
+#error "test_rpc needs OS_CFG_USE_MSG_RPC (1u)"
+#endif
+
+#define SIG_ECHO            (1)     /* Reply 8 bytes of pattern */
+#define SIG_HOLD            (2)     /* Keep msg, no reply */
+#define SIG_LATE_IDLE       (3)     /* Reply to held msg, caller not in a call */
+#define SIG_LATE_NEXT       (4)     /* Reply to held msg first, then to this one */
+#define TEST_TIME_OUT       (10u)
+#define TEST_GUARD          (0xEEu)
+
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+};
+
+static const uint8_t reply_pattern[8] = {0x11u, 0x22u, 0x33u, 0x44u, 0x55u, 0x66u, 0x77u, 0x88u};
+static msg_t *p_held;
+static volatile int late_idle_ret = -1;
+static volatile int late_next_ret = -1;
+static volatile uint32_t failures;
+
+static void check(uint8_t is_ok, const char *what)
+{
+    if (is_ok != OS_TRUE)
+    {
+        failures++;
+        ENTER_CRITICAL();
+        printf("FAIL: %s\n", what);
+        EXIT_CRITICAL();
+    }
+}
+
+/* Caller */
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    struct
+    {
+        uint8_t buf[2];
+        uint8_t guard[6];
+    } rsp_small;
+    uint32_t rsp;
+    uint16_t len;
+    uint8_t is_replied;
+    pool_stats_t stats;
+
+    /* Reply larger than caller buffer */
+    memset(&rsp_small, TEST_GUARD, sizeof(rsp_small));
+    len = sizeof(rsp_small.buf);
+    is_replied = os_task_call(TASK_2_ID, SIG_ECHO, NULL, 0u, rsp_small.buf, &len, TEST_TIME_OUT);
+    check(is_replied, "echo not replied");
+    check((len == sizeof(rsp_small.buf)) ? OS_TRUE : OS_FALSE, "reply len not cut to buffer");
+    check((memcmp(rsp_small.buf, reply_pattern, sizeof(rsp_small.buf)) == 0) ? OS_TRUE : OS_FALSE, "reply data wrong");
+    check((rsp_small.guard[0] == TEST_GUARD && rsp_small.guard[5] == TEST_GUARD) ? OS_TRUE : OS_FALSE,
+          "reply written past caller buffer");
+
+    /* Server replies after caller timed out and is back to idle */
+    rsp = 0u;
+    len = sizeof(rsp);
+    is_replied = os_task_call(TASK_2_ID, SIG_HOLD, NULL, 0u, &rsp, &len, TEST_TIME_OUT);
+    check((is_replied == OS_FALSE && len == 0u) ? OS_TRUE : OS_FALSE, "held call did not time out");
+    os_task_post_msg_pure(TASK_2_ID, SIG_LATE_IDLE);
+    os_task_delay(2u);
+    check((late_idle_ret == OS_FALSE) ? OS_TRUE : OS_FALSE, "late reply to idle caller accepted");
+    check((rsp == 0u) ? OS_TRUE : OS_FALSE, "late reply written to idle caller");
+
+    /* Server replies to timed out call while caller waits on its next call */
+    len = sizeof(rsp);
+    is_replied = os_task_call(TASK_2_ID, SIG_HOLD, NULL, 0u, &rsp, &len, TEST_TIME_OUT);
+    check((is_replied == OS_FALSE) ? OS_TRUE : OS_FALSE, "held call did not time out");
+    memset(&rsp_small, TEST_GUARD, sizeof(rsp_small));
+    len = sizeof(rsp_small);
+    is_replied = os_task_call(TASK_2_ID, SIG_LATE_NEXT, NULL, 0u, &rsp_small, &len, TEST_TIME_OUT);
+    check((late_next_ret == OS_FALSE) ? OS_TRUE : OS_FALSE, "reply with stale call_seq accepted");
+    check((is_replied == OS_TRUE && len == sizeof(reply_pattern)) ? OS_TRUE : OS_FALSE, "next call not replied");
+    check((memcmp(&rsp_small, reply_pattern, sizeof(reply_pattern)) == 0) ? OS_TRUE : OS_FALSE,
+          "next call got stale reply");
+
+    os_task_delay(2u);
+    os_msg_get_pool_stats(&stats);
+    check((stats.used == 0u) ? OS_TRUE : OS_FALSE, "msg leaked");
+
+    ENTER_CRITICAL();
+    printf("%s\n", (failures == 0u) ? "PASS" : "FAIL");
+    EXIT_CRITICAL();
+    exit((failures == 0u) ? 0 : 1);
+}
+
+/* Server */
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    static const uint8_t stale[8] = {0xAAu, 0xAAu, 0xAAu, 0xAAu, 0xAAu, 0xAAu, 0xAAu, 0xAAu};
+    for (;;)
+    {
+        msg_t *p_msg = os_task_wait_for_msg(OS_CFG_DELAY_MAX);
+        switch (p_msg->sig)
+        {
+        case SIG_ECHO:
+            os_task_reply(p_msg, (void *)reply_pattern, sizeof(reply_pattern));
+            break;
+        case SIG_HOLD:
+            p_held = p_msg;
+            continue;
+        case SIG_LATE_IDLE:
+            late_idle_ret = os_task_reply(p_held, (void *)stale, sizeof(stale));
+            os_msg_free(p_held);
+            break;
+        case SIG_LATE_NEXT:
+            late_next_ret = os_task_reply(p_held, (void *)stale, sizeof(stale));
+            os_msg_free(p_held);
+            os_task_reply(p_msg, (void *)reply_pattern, sizeof(reply_pattern));
+            break;
+        default:
+            break;
+        }
+        os_msg_free(p_msg);
+    }
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+int main()
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 0;
+}
@@ -0,0 +1,112 @@
+/* Coalesced signal under msg pool pressure, run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -I.. -I../Inc test_sig_coalesce.cpp plus every file in ../Src
+ * (Src files built as C, system.h from app), OS_CFG_USE_MSG_SIG_COALESCE set to (1u) in os_cfg.h.
+ * Receiver blocks with a signal pending while msg pool is empty, freeing one msg must wake it.
+ * Exit code 0 is pass.
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if (OS_CFG_USE_MSG_SIG_COALESCE == 0u)
+#error test_sig_coalesce needs OS_CFG_USE_MSG_SIG_COALESCE
+#endif
+
+#define TEST_SIG_FIRST  (100)
+#define TEST_SIG_NUM    (4u)
+
+/* Receiver above checker prio, so it runs and blocks as soon as it is woken */
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   2,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+};
+
+static msg_t *held_msgs[OS_CFG_MSG_POOL_SIZE];
+static volatile int32_t sig_got = -1;
+static volatile uint32_t num_empty_wakes;
+
+/* Checker: drains msg pool, posts coalesced signal, frees one msg */
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    uint16_t num_held = 0u;
+    uint16_t idx;
+    uint8_t is_pass;
+
+    os_task_delay(5u); /* Receiver is blocked on its empty queue */
+    ENTER_CRITICAL();
+    while (num_held < OS_CFG_MSG_POOL_SIZE)
+    {
+        held_msgs[num_held] = os_msg_make_pure(0);
+        if (held_msgs[num_held] == NULL)
+        {
+            break;
+        }
+        num_held++;
+    }
+    EXIT_CRITICAL();
+
+    /* Receiver wakes, finds no msg to take signal in and blocks again */
+    os_task_post_msg_pure(TASK_2_ID, TEST_SIG_FIRST + 1);
+    os_task_delay(5u);
+    /* Same signal again only sets pending bit, receiver stays blocked */
+    os_task_post_msg_pure(TASK_2_ID, TEST_SIG_FIRST + 1);
+    os_task_delay(5u);
+
+    os_msg_free(held_msgs[0]);
+    os_task_delay(5u);
+
+    is_pass = (sig_got == TEST_SIG_FIRST + 1) ? OS_TRUE : OS_FALSE;
+    ENTER_CRITICAL();
+    printf("held %u msgs, receiver woken empty %u times, got sig %d after free: %s\n",
+           (unsigned)num_held, (unsigned)num_empty_wakes, (int)sig_got, (is_pass == OS_TRUE) ? "PASS" : "FAIL");
+    EXIT_CRITICAL();
+    for (idx = 1u; idx < num_held; idx++)
+    {
+        os_msg_free(held_msgs[idx]);
+    }
+    exit((is_pass == OS_TRUE) ? 0 : 1);
+}
+
+/* Receiver of coalesced signals */
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    msg_t *p_msg;
+
+    os_task_coalesce_sig(TASK_2_ID, TEST_SIG_FIRST, TEST_SIG_NUM);
+    for (;;)
+    {
+        p_msg = os_task_wait_for_msg(OS_CFG_DELAY_MAX);
+        if (p_msg == NULL)
+        {
+            num_empty_wakes++; /* Signal is pending but msg pool is empty */
+            continue;
+        }
+        sig_got = p_msg->sig;
+        os_msg_free(p_msg);
+    }
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(1000u);
+    }
+}
+
+int main(void)
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 1;
+}
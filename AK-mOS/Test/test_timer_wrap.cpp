@@ -0,0 +1,107 @@
+/* Tick overflow test for timer task, run on Linux host port:
+ * g++ -DOS_CFG_PORT_POSIX=1 -DOS_CFG_TICK_COUNT_INIT=0xFFFFFE00u -I.. -I../Inc test_timer_wrap.cpp plus every file in ../Src
+ * (Src files built as C, system.h from app). Also run with OS_CFG_USE_TIMER_WHEEL and OS_CFG_USE_TICKLESS_IDLE set.
+ * Exit code 0 is pass.
+ */
+#include "os_kernel.h"
+#include "os_mem.h"
+#include "os_task.h"
+#include "os_msg.h"
+#include "os_timer.h"
+#include "task_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_PERIOD     (50u)
+#define TEST_RUN_TICKS  (1000u)
+
+/* Own table, app tasks below timer task prio so a timer task spinning over tick overflow starves them */
+const task_t app_task_table[] = {
+    /* TASK_ID      task_func   arg     prio    msg_queue_size  stk_size    queue_policy */
+    {TASK_1_ID,     task_1,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,     task_2,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,     task_3,     NULL,   1,      8,              100,        MSG_Q_OVERFLOW_ASSERT},
+};
+
+static volatile uint32_t periodic_fired;
+static volatile uint32_t periodic_late;
+static volatile uint32_t periodic_expect;
+static volatile uint32_t one_shot_tick;
+static volatile uint32_t wake_tick;
+static volatile uint8_t wake_done;
+
+static void periodic_cb(void)
+{
+    uint32_t tick = os_task_get_tick();
+    if ((periodic_fired != 0u) && (tick != periodic_expect))
+    {
+        periodic_late++;
+        ENTER_CRITICAL();
+        printf("periodic fired at %08x, expected %08x\n", (unsigned)tick, (unsigned)periodic_expect);
+        EXIT_CRITICAL();
+    }
+    periodic_expect = tick + TEST_PERIOD;
+    periodic_fired++;
+}
+
+static void one_shot_cb(void)
+{
+    one_shot_tick = os_task_get_tick();
+}
+
+/* Checker: periodic timer across overflow and one shot timer on last tick before it */
+void task_1(void *p_arg)
+{
+    (void)p_arg;
+    uint32_t time_start = os_task_get_tick();
+    uint8_t is_pass;
+    os_timer_t *p_periodic = os_timer_create((timer_id_t)0, 0, periodic_cb, TASK_2_ID, TEST_PERIOD, TIMER_PERIODIC);
+    os_timer_t *p_one_shot = os_timer_create((timer_id_t)1, 0, one_shot_cb, TASK_2_ID, 0u, TIMER_ONE_SHOT);
+
+    os_timer_start(p_periodic, TEST_PERIOD);
+    os_timer_start(p_one_shot, OS_CFG_DELAY_MAX - time_start);
+    while ((os_task_get_tick() - time_start) < TEST_RUN_TICKS)
+    {
+        os_task_delay(1u);
+    }
+
+    is_pass = ((periodic_late == 0u) && (periodic_fired >= (TEST_RUN_TICKS / TEST_PERIOD) - 1u) &&
+               (one_shot_tick == OS_CFG_DELAY_MAX) && (wake_done == OS_TRUE) && (wake_tick == OS_CFG_DELAY_MAX))
+                  ? OS_TRUE
+                  : OS_FALSE;
+    ENTER_CRITICAL();
+    printf("start %08x: periodic fired %u late %u, one shot at %08x, woken at %08x: %s\n",
+           (unsigned)time_start, (unsigned)periodic_fired, (unsigned)periodic_late, (unsigned)one_shot_tick,
+           (unsigned)wake_tick, (is_pass == OS_TRUE) ? "PASS" : "FAIL");
+    exit((is_pass == OS_TRUE) ? 0 : 1);
+}
+
+/* Must get CPU on last tick before overflow, timer task must be blocked by then */
+void task_2(void *p_arg)
+{
+    (void)p_arg;
+    os_task_delay(OS_CFG_DELAY_MAX - os_task_get_tick());
+    wake_tick = os_task_get_tick();
+    wake_done = OS_TRUE;
+    for (;;)
+    {
+        os_task_delay(TEST_RUN_TICKS);
+    }
+}
+
+void task_3(void *p_arg)
+{
+    (void)p_arg;
+    for (;;)
+    {
+        os_task_delay(TEST_RUN_TICKS);
+    }
+}
+
+int main(void)
+{
+    os_init();
+    os_task_create_list((task_t *)app_task_table, TASK_EOT_ID);
+    os_run();
+    return 1;
+}
@@ -15,22 +15,67 @@ extern "C"
 #include "system.h"
 #include <stdint.h>
 
+/* Port config */
+#ifndef OS_CFG_PORT_POSIX
+#define OS_CFG_PORT_POSIX                 (0u)  /* 1: run kernel as a Linux process (os_cpu_posix.c) instead of Cortex-M3 */
+#endif
+
 /* Kernel common config */
+#if (OS_CFG_PORT_POSIX == 1u)
+#define OS_CFG_HEAP_SIZE                  ((size_t)1024 * 8u)  /* 64-bit host: pointers, TCBs and pool blocks take about twice the bytes */
+#else
 #define OS_CFG_HEAP_SIZE                  ((size_t)1024 * 3u)
+#endif
 #define OS_CFG_PRIO_MAX                   (10)
+#define OS_CFG_PRIO_SOFT_CLZ              (0u)  /* 1: portable count leading zeros for prio lookup, even if compiler has a builtin */
 #define OS_CFG_DELAY_MAX                  ((uint32_t)0xffffffffUL)
+#ifndef OS_CFG_TICK_COUNT_INIT
+#define OS_CFG_TICK_COUNT_INIT            ((uint32_t)0u)  /* Tick count at start, e.g. 0xFFFFFE00 to test tick overflow early */
+#endif
+
+/* Memory config */
+#define OS_CFG_USE_MEM_TLSF               (0u)  /* 1: TLSF allocator (os_mem_tlsf.c), O(1) malloc/free, heap below 64KB */
+#define OS_CFG_MEM_TLSF_SL_LOG2           (3u)  /* TLSF: 2^n free lists per power of 2 of block size (max 5) */
 
 /* Task config */
 #define OS_CFG_TASK_STK_SIZE_MIN          ((size_t)17u) // (Min > 64 byte) In stack, equal to x 4 bytes
 #define OS_CFG_TASK_STACK_FILL_BYTE       (0x5Au)
 #define OS_CFG_TASK_MSG_Q_SIZE_NORMAL     (8u)
 
+/* Tickless idle config */
+#define OS_CFG_USE_TICKLESS_IDLE          (0u)  /* 1: idle task stops tick till next delayed task or timer */
+#define OS_CFG_TICKLESS_IDLE_MIN          (2u)  /* Min expected idle ticks to stop tick */
+
+/* Timing wheel config */
+#define OS_CFG_USE_DLY_WHEEL              (0u)  /* 1: delayed tasks are kept in a timing wheel, O(1) insert/remove */
+#define OS_CFG_USE_TIMER_WHEEL            (0u)  /* 1: running timers are kept in a timing wheel, O(1) start/stop/reset */
+#define OS_CFG_WHEEL_SLOT_BITS            (3u)  /* Slots per level = 2^bits */
+#define OS_CFG_WHEEL_LEVELS               (4u)  /* Ticks covered without re-cascade = 2^(bits * levels) */
+
 /* Messages config */
 #define OS_CFG_MSG_POOL_SIZE              (32u)
+#define OS_CFG_MSG_INLINE_SIZE            (0u)  /* Dynamic payloads up to this size are kept inside msg_t, no alloc. 0: disabled */
+#define OS_CFG_USE_MSG_PAYLOAD_POOL       (0u)  /* 1: dynamic msg payloads from size-class pools, heap only when a class is empty */
+#define OS_CFG_MSG_PAYLOAD_SIZES          {8u, 16u, 32u, 64u, 128u, 255u} /* Ascending, bytes */
+#define OS_CFG_MSG_PAYLOAD_NUMS           {4u, 4u, 2u, 2u, 1u, 1u}        /* Blocks per class, taken from heap on init */
+#define OS_CFG_USE_MSG_POST_TIMEOUT       (0u)  /* 1: post variants that block sender while destination queue is full */
+#define OS_CFG_USE_MSG_PUBSUB             (0u)  /* 1: tasks subscribe to signal ranges, one publish shares one payload */
+#define OS_CFG_MSG_SUB_MAX                (8u)  /* Max num of subscribed signal ranges */
+#define OS_CFG_USE_MSG_SIG_COALESCE       (0u)  /* 1: pure signals in a declared range set a pending bit instead of taking a msg */
+#define OS_CFG_USE_MSG_WAIT_SIG           (0u)  /* 1: task can wait for msgs matching a signal mask or predicate */
+#define OS_CFG_USE_MSG_RPC                (0u)  /* 1: synchronous call/reply between tasks, reply is copied into caller buffer */
+#define OS_CFG_USE_TASK_HANDOFF           (0u)  /* 1: a post can hand CPU straight to an equal prio receiver it wakes */
+#define OS_CFG_USE_MSG_URGENT             (0u)  /* 1: each task has an urgent lane, always received before its msg queue */
+#define OS_CFG_MSG_URGENT_Q_SIZE          (2u)  /* Depth of urgent lane, bulk msgs can not take these slots. Full lane always asserts and
+                                                   rejects the post (MSG_Q_OVERFLOW_ASSERT), queue_policy of task is not used */
 
 /* Timers config */
-#define OS_CFG_TIMER_POOL_SIZE            (8u)  /* Max num of timer */
+#define OS_CFG_TIMER_POOL_SIZE            (8u)  /* Max num of timer (up to 65535) */
 #define OS_CFG_TIMER_TASK_PRI             (0u)  /* Recommend as high as possible */
+#define OS_CFG_USE_TIMER_TASK             (1u)  /* 0: no timer task, timers expire in tick interrupt */
+#define OS_CFG_TIMER_CB_Q_SIZE            (4u)  /* No timer task: callbacks queued for idle task */
+#define OS_CFG_TIMER_CB_STK_SIZE          (80u) /* No timer task: idle stack added for callbacks */
+#define OS_CFG_USE_TIMER_HARD             (0u)  /* 1: hard timers, callbacks run in tick interrupt */
 
 /* Log config */
 #define OS_CFG_USE_LOG                    (1u)  
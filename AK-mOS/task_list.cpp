@@ -3,9 +3,9 @@
 const task_t app_task_table[] = {
     /*************************************************************************/
     /* TASK */
-    /* TASK_ID          task_func     arg     prio   msg_queue_size    stk_size */
+    /* TASK_ID          task_func     arg     prio   msg_queue_size    stk_size    queue_policy */
     /*************************************************************************/
-    {TASK_1_ID,   	    task_1,       NULL,   0,      8,                100},
-    {TASK_2_ID,   	    task_2,       NULL,   0,      8,                100}, 
-    {TASK_3_ID,   	    task_3,       NULL,   0,      8,                100}, 
+    {TASK_1_ID,   	    task_1,       NULL,   0,      8,                100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_2_ID,   	    task_2,       NULL,   0,      8,                100,        MSG_Q_OVERFLOW_ASSERT},
+    {TASK_3_ID,   	    task_3,       NULL,   0,      8,                100,        MSG_Q_OVERFLOW_ASSERT},
 };